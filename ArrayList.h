@@ -0,0 +1,569 @@
+/*
+    ArrayList.h
+
+    Contains the ArrayList function implementation. An ArrayList
+    offers the same interface as a LinkedList, but keeps its items
+    in one contiguous block so that operator[] is constant time.
+*/
+
+#ifndef __ARRAY_LIST_H__
+#define __ARRAY_LIST_H__
+
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <sstream>
+#include <utility>
+using std::out_of_range;
+using std::ostream;
+using std::cout;
+using std::stringstream;
+
+#ifdef DEBUG
+#include <vector>
+using std::vector;
+#endif
+
+template <typename T>
+class ArrayList {
+private:
+    T *data;
+    unsigned int count;
+    unsigned int capacity;
+    void grow(unsigned int minCapacity);
+    void openGap(unsigned int pos);
+public:
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    ArrayList();
+    ArrayList(const ArrayList& lst);
+    ArrayList(ArrayList&& lst) noexcept;
+    ~ArrayList();
+    ArrayList<T>& operator=(const ArrayList& lst);
+    ArrayList<T>& operator=(ArrayList&& lst) noexcept;
+    void clear();
+    void reserve(unsigned int n);
+    unsigned int size() const;
+    bool empty() const;
+    ArrayList<T>& push_front(const T& item);
+    ArrayList<T>& push_front(T&& item);
+    ArrayList<T>& push_back(const T& item);
+    ArrayList<T>& push_back(T&& item);
+    ArrayList<T>& push(const T& item);
+    ArrayList<T>& push(T&& item);
+    template <typename... Args>
+    T& emplace_front(Args&&... args);
+    template <typename... Args>
+    T& emplace_back(Args&&... args);
+    T pop_front();
+    T pop_back();
+    T pop();
+    T& peek_front();
+    T& peek_back();
+    T& peek();
+    const T& peek_front() const;
+    const T& peek_back() const;
+    const T& peek() const;
+
+    void insertAt(unsigned int pos, const T& item);
+    void insertAt(unsigned int pos, T&& item);
+    void deleteAt(unsigned int pos);
+    bool remove(const T& item);
+    bool contains(const T& item) const;
+    T& operator[](const unsigned int pos);
+    const T& operator[](const unsigned int pos) const;
+
+    iterator begin() { return data; }
+    iterator end() { return data + count; }
+    const_iterator begin() const { return data; }
+    const_iterator end() const { return data + count; }
+
+#ifdef DEBUG
+    static bool test();
+    static bool check(const vector<int>& v, const ArrayList<int>& lst);
+#endif
+
+    friend ostream& operator<<(ostream& strm, const ArrayList<T>& lst) {
+        strm << "[";
+        for (unsigned int i=0; i<lst.count; i++) {
+            if (i > 0) strm << ",";
+            strm << lst.data[i];
+        }
+        strm << "]";
+        return strm;
+    }
+};
+
+// Default constructor
+template <typename T>
+ArrayList<T>::ArrayList() : data(NULL), count(0), capacity(0) { }
+
+// Copy constructor
+template <typename T>
+ArrayList<T>::ArrayList(const ArrayList& lst) : data(NULL), count(0), capacity(0) {
+    reserve(lst.count);
+    for (unsigned int i=0; i<lst.count; i++) {
+        new (data + i) T(lst.data[i]);
+    }
+    count = lst.count;
+}
+
+// Move constructor
+// The storage is taken over from lst, which is left empty.
+template <typename T>
+ArrayList<T>::ArrayList(ArrayList&& lst) noexcept : data(lst.data), count(lst.count), capacity(lst.capacity) {
+    lst.data = NULL;
+    lst.count = lst.capacity = 0;
+}
+
+// Destructor
+template <typename T>
+ArrayList<T>::~ArrayList() {
+    clear();
+    ::operator delete(data);
+}
+
+// Assignment operator
+template <typename T>
+ArrayList<T>& ArrayList<T>::operator=(const ArrayList& lst) {
+    if (this != &lst) {
+        clear();
+        reserve(lst.count);
+        for (unsigned int i=0; i<lst.count; i++) {
+            new (data + i) T(lst.data[i]);
+        }
+        count = lst.count;
+    }
+    return *this;
+}
+
+// Move assignment operator
+template <typename T>
+ArrayList<T>& ArrayList<T>::operator=(ArrayList&& lst) noexcept {
+    if (this != &lst) {
+        clear();
+        ::operator delete(data);
+        data = lst.data;
+        count = lst.count;
+        capacity = lst.capacity;
+        lst.data = NULL;
+        lst.count = lst.capacity = 0;
+    }
+    return *this;
+}
+
+// Move the items into a larger block, at least doubling the capacity
+// so that a run of push_back calls is amortized constant time
+template <typename T>
+void ArrayList<T>::grow(unsigned int minCapacity) {
+    unsigned int newCapacity = (capacity == 0) ? 4 : capacity * 2;
+    if (newCapacity < minCapacity) newCapacity = minCapacity;
+    T *newData = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+    for (unsigned int i=0; i<count; i++) {
+        new (newData + i) T(std::move_if_noexcept(data[i]));
+        data[i].~T();
+    }
+    ::operator delete(data);
+    data = newData;
+    capacity = newCapacity;
+}
+
+// Remove all items from list (the storage is kept for reuse)
+template <typename T>
+void ArrayList<T>::clear() {
+    for (unsigned int i=0; i<count; i++) data[i].~T();
+    count = 0;
+}
+
+// Make room for at least n items without further reallocation
+template <typename T>
+void ArrayList<T>::reserve(unsigned int n) {
+    if (n > capacity) grow(n);
+}
+
+// Return number of items in list
+template <typename T>
+unsigned int ArrayList<T>::size() const {
+    return count;
+}
+
+// Return true if list has no items
+template <typename T>
+bool ArrayList<T>::empty() const {
+    return count == 0;
+}
+
+// Add an item to the front of the list
+template <typename T>
+ArrayList<T>& ArrayList<T>::push_front(const T& item) {
+    insertAt(0, item);
+    return *this;
+}
+
+// Move an item to the front of the list
+template <typename T>
+ArrayList<T>& ArrayList<T>::push_front(T&& item) {
+    insertAt(0, std::move(item));
+    return *this;
+}
+
+// Add an item to the back of the list
+template <typename T>
+ArrayList<T>& ArrayList<T>::push_back(const T& item) {
+    emplace_back(item);
+    return *this;
+}
+
+// Move an item to the back of the list
+template <typename T>
+ArrayList<T>& ArrayList<T>::push_back(T&& item) {
+    emplace_back(std::move(item));
+    return *this;
+}
+
+// Add an item to the list (alias for push_back)
+template <typename T>
+ArrayList<T>& ArrayList<T>::push(const T& item) {
+    return push_back(item);
+}
+
+// Move an item to the list (alias for push_back)
+template <typename T>
+ArrayList<T>& ArrayList<T>::push(T&& item) {
+    return push_back(std::move(item));
+}
+
+// Construct an item in place at the front of the list
+template <typename T>
+template <typename... Args>
+T& ArrayList<T>::emplace_front(Args&&... args) {
+    T item(std::forward<Args>(args)...);
+    insertAt(0, std::move(item));
+    return data[0];
+}
+
+// Construct an item in place at the back of the list
+// The item is built before growing, so args may refer into the list.
+template <typename T>
+template <typename... Args>
+T& ArrayList<T>::emplace_back(Args&&... args) {
+    if (count == capacity) {
+        T item(std::forward<Args>(args)...);
+        grow(count + 1);
+        new (data + count) T(std::move(item));
+    } else {
+        new (data + count) T(std::forward<Args>(args)...);
+    }
+    count++;
+    return data[count-1];
+}
+
+// Remove an item from the front of the list
+template <typename T>
+T ArrayList<T>::pop_front() {
+    if (count == 0) throw out_of_range("Attempt to pop from empty list");
+    T item(std::move(data[0]));
+    deleteAt(0);
+    return item;
+}
+
+// Remove an item from the back of the list
+template <typename T>
+T ArrayList<T>::pop_back() {
+    if (count == 0) throw out_of_range("Attempt to pop from empty list");
+    T item(std::move(data[count-1]));
+    data[count-1].~T();
+    count--;
+    return item;
+}
+
+// Remove an item from (the back of) the list
+template <typename T>
+T ArrayList<T>::pop() {
+    return pop_back();
+}
+
+// Return data from first list element
+template <typename T>
+T& ArrayList<T>::peek_front() {
+    if (count == 0) throw out_of_range("Attempt to peek at empty list");
+    return data[0];
+}
+
+// Return data from last list element
+template <typename T>
+T& ArrayList<T>::peek_back() {
+    if (count == 0) throw out_of_range("Attempt to peek at empty list");
+    return data[count-1];
+}
+
+// Return data from last list element
+template <typename T>
+T& ArrayList<T>::peek() {
+    return peek_back();
+}
+
+// Return data from first list element
+template <typename T>
+const T& ArrayList<T>::peek_front() const {
+    if (count == 0) throw out_of_range("Attempt to peek at empty list");
+    return data[0];
+}
+
+// Return data from last list element
+template <typename T>
+const T& ArrayList<T>::peek_back() const {
+    if (count == 0) throw out_of_range("Attempt to peek at empty list");
+    return data[count-1];
+}
+
+// Return data from last list element
+template <typename T>
+const T& ArrayList<T>::peek() const {
+    return peek_back();
+}
+
+// Shift the items from pos onwards one place towards the back,
+// leaving data[pos] holding a moved-from item. pos must be < count.
+template <typename T>
+void ArrayList<T>::openGap(unsigned int pos) {
+    if (count == capacity) grow(count + 1);
+    new (data + count) T(std::move(data[count-1]));
+    for (unsigned int i=count-1; i>pos; i--) {
+        data[i] = std::move(data[i-1]);
+    }
+    count++;
+}
+
+// Insert an item at a specified position in the list
+// Items after pos are shifted one place towards the back.
+template <typename T>
+void ArrayList<T>::insertAt(unsigned int pos, const T& item) {
+    if (pos > count) throw out_of_range("Attempt to insert beyond bounds");
+    T copy(item);
+    insertAt(pos, std::move(copy));
+}
+
+// Move an item to a specified position in the list
+// Items after pos are shifted one place towards the back.
+template <typename T>
+void ArrayList<T>::insertAt(unsigned int pos, T&& item) {
+    if (pos > count) throw out_of_range("Attempt to insert beyond bounds");
+    if (pos == count) {
+        emplace_back(std::move(item));
+        return;
+    }
+    openGap(pos);
+    data[pos] = std::move(item);
+}
+
+// Delete an item at a specified position
+// Items after pos are shifted one place towards the front.
+template <typename T>
+void ArrayList<T>::deleteAt(unsigned int pos) {
+    if (pos >= count) throw out_of_range("Attempt to delete beyond bounds");
+    for (unsigned int i=pos; i<count-1; i++) {
+        data[i] = std::move(data[i+1]);
+    }
+    data[count-1].~T();
+    count--;
+}
+
+// Delete a particular value from list
+// Returns true or false based on whether value was found.
+template <typename T>
+bool ArrayList<T>::remove(const T& item) {
+    for (unsigned int i=0; i<count; i++) {
+        if (data[i] == item) {
+            deleteAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Find out if the list contains a particular value
+// Returns true or false based on whether value was found.
+template <typename T>
+bool ArrayList<T>::contains(const T& item) const {
+    for (unsigned int i=0; i<count; i++) {
+        if (data[i] == item) return true;
+    }
+    return false;
+}
+
+// Overload of [] operator
+template <typename T>
+T& ArrayList<T>::operator[](const unsigned int pos) {
+    if (pos >= count) {
+        stringstream strm;
+        strm << "Attempted access beyond bounds [" << pos << "]";
+        throw out_of_range(strm.str());
+    }
+    return data[pos];
+}
+
+// Overload of [] operator for const lists
+template <typename T>
+const T& ArrayList<T>::operator[](const unsigned int pos) const {
+    if (pos >= count) {
+        stringstream strm;
+        strm << "Attempted access beyond bounds [" << pos << "]";
+        throw out_of_range(strm.str());
+    }
+    return data[pos];
+}
+
+#ifdef DEBUG
+template <typename T>
+bool ArrayList<T>::test() {
+    int errors = 0;
+    int tests = 0;
+
+    ArrayList<int> lst;
+    vector<int> v;
+
+    // Test default constructor
+    tests++;
+    if (!check(v, lst)) {
+        cout << "Error: default constructor\n";
+        errors++;
+    } else {
+        cout << "Passed: default constructor test\n";
+    }
+
+    // Test push_front(T) and push_back(T) functions
+    lst.push_front(2).push_front(1);
+    lst.push_back(3).push(4);
+    v.push_back(1);
+    v.push_back(2);
+    v.push_back(3);
+    v.push_back(4);
+    tests++;
+    if (!check(v, lst)) {
+        cout << "Error: push_front(int)/push_back(int)\n";
+        errors++;
+    } else {
+        cout << "Passed: push_front(int)/push_back(int) test\n";
+    }
+
+    // Test growth past the initial capacity
+    for (int i=5; i<=100; i++) {
+        lst.push_back(i);
+        v.push_back(i);
+    }
+    tests++;
+    if (!check(v, lst)) {
+        cout << "Error: growth\n";
+        errors++;
+    } else {
+        cout << "Passed: growth test\n";
+    }
+
+    // Test insertAt(int, T) function
+    tests++;
+    lst.insertAt(0, 11);
+    lst.insertAt(2, 12);
+    lst.insertAt(lst.size(), 13);
+    v.insert(v.begin(), 11);
+    v.insert(v.begin()+2, 12);
+    v.insert(v.end(), 13);
+    if (!check(v, lst)) {
+        cout << "Error: insertAt(int, int)\n";
+        errors++;
+    } else {
+        cout << "Passed: insertAt(int, int) test\n";
+    }
+
+    // Test deleteAt(int) function
+    tests++;
+    v.erase(v.begin());
+    v.erase(v.begin()+1);
+    v.erase(v.begin()+(v.size()-1));
+    lst.deleteAt(0);
+    lst.deleteAt(1);
+    lst.deleteAt(lst.size()-1);
+    if (!check(v, lst)) {
+        cout << "Error: deleteAt(int)\n";
+        errors++;
+    } else {
+        cout << "Passed: deleteAt(int) test\n";
+    }
+
+    // Test remove(T) and contains(T) functions
+    tests++;
+    lst.remove(50);
+    v.erase(v.begin()+49);
+    if (!check(v, lst) || lst.contains(50) || !lst.contains(51) || lst.remove(1000)) {
+        cout << "Error: remove(int)/contains(int)\n";
+        errors++;
+    } else {
+        cout << "Passed: remove(int)/contains(int) test\n";
+    }
+
+    // Test copy constructor and assignment operator
+    tests++;
+    ArrayList<int> lst2(lst);
+    ArrayList<int> lst3;
+    lst3.push(7);
+    lst3 = lst;
+    if (!check(v, lst2) || !check(v, lst3)) {
+        cout << "Error: copy constructor/assignment\n";
+        errors++;
+    } else {
+        cout << "Passed: copy constructor/assignment test\n";
+    }
+
+    // Test move constructor, move assignment and emplace functions
+    tests++;
+    ArrayList<int> lst4(std::move(lst3));
+    ArrayList<int> lst5;
+    lst5 = std::move(lst4);
+    lst5.emplace_front(-1);
+    lst5.emplace_back(lst5[0]) = -2;
+    if (lst3.size() != 0 || lst4.size() != 0 || lst5.size() != v.size()+2 ||
+        lst5.peek_front() != -1 || lst5.peek_back() != -2) {
+        cout << "Error: move/emplace\n";
+        errors++;
+    } else {
+        cout << "Passed: move/emplace test\n";
+    }
+
+    // Test pop*() and peek*() functions
+    tests++;
+    if (lst.peek_front() != v.front() || lst.pop_front() != v.front() ||
+        lst.peek() != v.back() || lst.pop() != v.back() ||
+        lst.size() != v.size()-2) {
+        cout << "Error: pop*/peek*\n";
+        errors++;
+    } else {
+        cout << "Passed: pop*/peek* test\n";
+    }
+
+    // Test clear() and empty() functions
+    lst.clear();
+    tests++;
+    if (lst.size() != 0 || !lst.empty() || lst2.size() == 0) {
+        cout << "Error: clear()\n";
+        errors++;
+    } else {
+        cout << "Passed: clear() test\n";
+    }
+
+    cout << tests << " tests attempted\n";
+    cout << errors << " errors encountered\n";
+    return errors == 0;
+}
+
+template <typename T>
+bool ArrayList<T>::check(const vector<int>& v, const ArrayList<int>& lst) {
+    if (v.size() != lst.size() || lst.count > lst.capacity) return false;
+    for (unsigned int i=0; i<lst.count; i++) {
+        if (lst.data[i] != v[i]) return false;
+    }
+    return true;
+}
+
+#endif
+#endif
@@ -0,0 +1,227 @@
+/*
+    BatchRunner.cpp
+
+    This is the implementation file for a BatchRunner object.
+*/
+
+#include "BatchRunner.h"
+#include "GameSession.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <dirent.h>
+#include <streambuf>
+#include <sys/stat.h>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+// A stream buffer that keeps only a 64-bit FNV-1a hash of what is written
+class HashOutput : public std::streambuf {
+public:
+    uint64_t hash = FNV_OFFSET;
+    void add(const char* s, std::size_t n) {
+        for (std::size_t i=0; i<n; i++) {
+            hash ^= (unsigned char)s[i];
+            hash *= FNV_PRIME;
+        }
+    }
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) {
+            char ch = (char)c;
+            add(&ch, 1);
+        }
+        return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        add(s, n);
+        return n;
+    }
+};
+
+// A stream buffer that throws away what is written
+class DiscardOutput : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override {
+        return c;
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+    }
+};
+
+// Split text into lines, without their line ends; a last line with no
+// line end still counts
+void splitLines(string_view text, std::vector<string_view>& lines) {
+    std::size_t start = 0;
+    while (start < text.size()) {
+        std::size_t end = text.find('\n', start);
+        if (end == string_view::npos) end = text.size();
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+string hex(uint64_t value) {
+    char text[17];
+    snprintf(text, sizeof text, "%016llx", (unsigned long long)value);
+    return text;
+}
+
+}
+
+BatchRunner::BatchRunner(const Dungeon& dungeon, OutputMode mode, unsigned int threads)
+    : dungeon(dungeon), mode(mode), threads(threads == 0 ? 1 : threads) {}
+
+void BatchRunner::addScript(const char* filename) {
+    struct stat info;
+    if (stat(filename, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        // a missing file is reported as that game's error
+        games.push_back(Game());
+        games.back().name = filename;
+        games.back().scriptFile = filename;
+        return;
+    }
+    DIR* dir = opendir(filename);
+    if (dir == NULL) throw string("Error: Could not read script directory ") + filename;
+    std::vector<string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        string path = string(filename) + "/" + entry->d_name;
+        if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) names.push_back(path);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    for (const string& name : names) {
+        games.push_back(Game());
+        games.back().name = name;
+        games.back().scriptFile = name;
+    }
+}
+
+void BatchRunner::addStream(const char* filename) {
+    try {
+        streams.emplace_back(new MappedFile(string(filename) == "-" ? "/dev/stdin" : filename));
+    } catch (string msg) {
+        throw string("Error: Could not read script stream ") + filename;
+    }
+    std::vector<string_view> lines;
+    splitLines(streams.back()->text(), lines);
+
+    // each line is a game name, then that game's next command
+    std::unordered_map<string_view, unsigned int> byName;
+    for (string_view line : lines) {
+        std::size_t start = line.find_first_not_of(" \t\r");
+        if (start == string_view::npos) continue;
+        std::size_t end = line.find_first_of(" \t\r", start);
+        if (end == string_view::npos) end = line.size();
+        string_view name = line.substr(start, end - start);
+        std::size_t commandAt = line.find_first_not_of(" \t", end);
+        string_view command = (commandAt == string_view::npos) ? string_view() : line.substr(commandAt);
+
+        std::unordered_map<string_view, unsigned int>::iterator it = byName.find(name);
+        if (it == byName.end()) {
+            it = byName.emplace(name, games.size()).first;
+            games.push_back(Game());
+            games.back().name = string(name);
+        }
+        games[it->second].commands.push_back(command);
+    }
+}
+
+// Play one game from start to finish
+void BatchRunner::play(Game& game) const {
+    game.played = 0;
+    game.outputHash = FNV_OFFSET;
+    game.stateDigest = FNV_OFFSET;
+    game.output.clear();
+    try {
+        std::unique_ptr<MappedFile> file;
+        std::vector<string_view> fileCommands;
+        const std::vector<string_view>* commands = &game.commands;
+        if (!game.scriptFile.empty()) {
+            try {
+                file.reset(new MappedFile(game.scriptFile.c_str()));
+            } catch (string msg) {
+                throw string("Error: Could not read script ") + game.scriptFile;
+            }
+            splitLines(file->text(), fileCommands);
+            commands = &fileCommands;
+        }
+
+        HashOutput hashed;
+        DiscardOutput discarded;
+        StringOutput text(&game.output);
+        std::streambuf* target = &discarded;
+        if (mode == HASH) target = &hashed;
+        else if (mode == TEXT) target = &text;
+        ostream out(target);
+
+        GameSession session(dungeon);
+        session.prompts = false;
+        session.prompt(out);
+        for (string_view command : *commands) {
+            if (session.done) break;
+            session.perform(command, out);
+            game.played++;
+            if (!session.done) session.prompt(out);
+        }
+        out << "Thanks for playing. Visit again soon.\n";
+
+        if (mode == TEXT) hashed.add(game.output.data(), game.output.size());
+        game.outputHash = hashed.hash;
+        HashOutput state;
+        ostream stateOut(&state);
+        session.writeState(stateOut);
+        game.stateDigest = state.hash;
+    } catch (string msg) {
+        game.error = msg;
+    }
+}
+
+void BatchRunner::run(ostream& report) {
+    unsigned int workers = std::min<std::size_t>(threads, games.size());
+    if (workers == 0) workers = 1;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::atomic<unsigned int> next(0);
+    auto worker = [this, &next]() {
+        for (unsigned int g = next++; g < games.size(); g = next++) play(games[g]);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int t=1; t<workers; t++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // combine the games' hashes in game order, so the totals do not
+    // depend on which thread played which game
+    unsigned long long commands = 0;
+    unsigned int errors = 0;
+    HashOutput output, state;
+    for (const Game& game : games) {
+        commands += game.played;
+        if (!game.error.empty()) errors++;
+        output.add(reinterpret_cast<const char*>(&game.outputHash), sizeof game.outputHash);
+        state.add(reinterpret_cast<const char*>(&game.stateDigest), sizeof game.stateDigest);
+    }
+
+    report << "Played " << games.size() << (games.size() == 1 ? " game, " : " games, ") << commands << " commands in " << seconds << " s ("
+           << (seconds > 0 ? (unsigned long long)(commands / seconds) : 0) << " commands/sec) on "
+           << workers << (workers == 1 ? " thread" : " threads") << '\n';
+    if (mode != DISCARD) report << "Output hash: " << hex(output.hash) << '\n';
+    report << "State digest: " << hex(state.hash) << '\n';
+    if (errors > 0) {
+        report << errors << (errors == 1 ? " game" : " games") << " failed:\n";
+        for (const Game& game : games) {
+            if (!game.error.empty()) report << "  " << game.name << ": " << game.error << '\n';
+        }
+    }
+    if (mode == TEXT) {
+        for (const Game& game : games) report << "== " << game.name << " ==\n" << game.output;
+    }
+}
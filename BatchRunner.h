@@ -0,0 +1,76 @@
+/*
+    BatchRunner.h
+
+    This is the header file for a BatchRunner object. A BatchRunner
+    plays scripted games without a player: each script is a list of
+    commands, one per line, played as its own GameSession with no
+    prompts.
+
+    Scripts come from files (one game per file; a directory stands for
+    every file in it) or from a stream of interleaved games, where each
+    line is a game name followed by a command for that game. Games are
+    shared out among worker threads; each plays against its own
+    WorldOverlay on the one loaded Dungeon, so games cannot see each
+    other's changes and the results do not depend on the thread count.
+
+    The output of every game can be thrown away, hashed, or kept and
+    printed. The report gives the number of commands carried out per
+    second, a hash of all output, and a digest of every game's final
+    state (see GameSession::writeState).
+*/
+
+#ifndef __BATCH_RUNNER_H__
+#define __BATCH_RUNNER_H__
+
+#include "Dungeon.h"
+#include "DungeonLoader.h"
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+using std::ostream;
+using std::string;
+using std::string_view;
+
+class BatchRunner {
+public:
+    enum OutputMode {
+        DISCARD,    // output is thrown away
+        HASH,       // output is hashed, not kept
+        TEXT        // output is kept and printed after the report
+    };
+
+    BatchRunner(const Dungeon& dungeon, OutputMode mode, unsigned int threads);
+    // Add a script file as one game, or every file in a directory
+    // This will throw an exception if the directory cannot be read.
+    void addScript(const char* filename);
+    // Add the interleaved games in a stream, "-" for standard input
+    // This will throw an exception if the stream cannot be read.
+    void addStream(const char* filename);
+    // Play every game and write the report (and the output, in TEXT mode)
+    void run(ostream& report);
+
+    unsigned int gameCount() const { return games.size(); }
+private:
+    struct Game {
+        string name;
+        string scriptFile;                  // read when played, or empty
+        std::vector<string_view> commands;  // from a stream, if no scriptFile
+        unsigned int played;                // commands carried out
+        uint64_t outputHash;
+        uint64_t stateDigest;
+        string output;                      // in TEXT mode
+        string error;
+    };
+    const Dungeon& dungeon;
+    OutputMode mode;
+    unsigned int threads;
+    std::vector<Game> games;
+    std::vector<std::unique_ptr<MappedFile> > streams;
+
+    void play(Game& game) const;
+};
+
+#endif
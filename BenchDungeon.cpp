@@ -0,0 +1,259 @@
+/*
+    BenchDungeon.cpp
+
+    Microbenchmarks for the list containers and the Dungeon lookup
+    routines. Each benchmark runs at sizes from 10 up to a maximum
+    (1,000,000 by default) and is compared against the standard
+    containers where there is one to compare against.
+
+    Build and run:
+        g++ -std=c++17 -O2 -pthread -o BenchDungeon BenchDungeon.cpp Dungeon.cpp DungeonGraph.cpp RegionPager.cpp RoomTextCache.cpp RoutePlanner.cpp Symbol.cpp Trigger.cpp WorldOverlay.cpp
+        ./BenchDungeon [maxSize] [filter]
+
+    Only benchmarks whose name contains filter are run. Output is one
+    line per benchmark, container and size, giving the time and the
+    number of heap allocations per operation.
+*/
+#include "LinkedList.h"
+#include "ArrayList.h"
+#include "Dungeon.h"
+#include "WorldOverlay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <new>
+#include <string>
+#include <vector>
+using std::deque;
+using std::list;
+using std::string;
+using std::vector;
+
+// Every heap allocation in the program goes through these, so the
+// benchmarks can report allocations per operation.
+static unsigned long long allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Lookups that are linear in the container size are timed over at
+// most this many operations, so large sizes finish in reasonable time.
+static const unsigned int SAMPLE_OPS = 1000;
+
+// Keeps the optimizer from discarding the work being measured
+static volatile unsigned long long sink = 0;
+
+// Small deterministic generator for lookup keys
+static unsigned int nextRandom(unsigned int& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static const char* filter = "";
+
+// Run f, which performs ops operations, and print the cost per operation
+template <typename F>
+void measure(const char* bench, const char* container, unsigned int n, unsigned int ops, F f) {
+    if (strstr(bench, filter) == NULL) return;
+    unsigned long long allocsBefore = allocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    unsigned long long allocs = allocations - allocsBefore;
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    printf("%-12s %-12s %10u %12.1f ns/op %8.3f allocs/op\n",
+           bench, container, n, ns / ops, (double)allocs / ops);
+}
+
+// Indexed access: std::list has no operator[], so walk it like LinkedList does
+template <typename C>
+int& at(C& c, unsigned int i) {
+    return c[i];
+}
+int& at(list<int>& c, unsigned int i) {
+    return *std::next(c.begin(), i);
+}
+
+// Removal of a value, with the interface each container offers
+template <typename C>
+void removeValue(C& c, int value) {
+    c.remove(value);
+}
+template <typename C>
+void eraseValue(C& c, int value) {
+    for (typename C::iterator it = c.begin(); it != c.end(); ++it) {
+        if (*it == value) {
+            c.erase(it);
+            return;
+        }
+    }
+}
+void removeValue(vector<int>& c, int value) {
+    eraseValue(c, value);
+}
+void removeValue(deque<int>& c, int value) {
+    eraseValue(c, value);
+}
+
+// Run every container benchmark for one container type at size n
+template <typename C>
+void benchContainer(const char* name, unsigned int n) {
+    measure("push", name, n, n, [&]() {
+        C c;
+        for (unsigned int i=0; i<n; i++) c.push_back(i);
+        sink += c.size();
+    });
+
+    C c;
+    for (unsigned int i=0; i<n; i++) c.push_back(i);
+
+    bool linear = (strcmp(name, "LinkedList") == 0 || strcmp(name, "std::list") == 0);
+    unsigned int ops = (linear && n > SAMPLE_OPS) ? SAMPLE_OPS : n;
+    measure("index", name, n, ops, [&]() {
+        unsigned int state = 1;
+        unsigned long long sum = 0;
+        for (unsigned int i=0; i<ops; i++) sum += at(c, nextRandom(state) % n);
+        sink += sum;
+    });
+
+    measure("iterate", name, n, n, [&]() {
+        unsigned long long sum = 0;
+        for (int value : c) sum += value;
+        sink += sum;
+    });
+
+    measure("copy", name, n, n, [&]() {
+        C copy(c);
+        sink += copy.size();
+    });
+
+    ops = (n > SAMPLE_OPS) ? SAMPLE_OPS : n;
+    measure("remove", name, n, ops, [&]() {
+        unsigned int state = 2;
+        for (unsigned int i=0; i<ops; i++) removeValue(c, nextRandom(state) % n);
+        sink += c.size();
+    });
+}
+
+// Build a dungeon of n rooms laid out in a row, each joined to its
+// neighbours, plus up and down paths for getPath to skip over
+static void buildDungeon(Dungeon& dungeon, unsigned int n) {
+    char id[32];
+    for (unsigned int i=0; i<n; i++) {
+        snprintf(id, sizeof id, "room %u", i);
+        dungeon.addRoom(Symbol(id), "a room", "A plain room used for benchmarking.");
+    }
+    for (unsigned int i=0; i<n; i++) {
+        Room& room = dungeon.rooms[i];
+        room.addPath(Symbol("u"), room.id);
+        room.addPath(Symbol("d"), room.id);
+        if (i > 0) room.addPath(Symbol("w"), dungeon.rooms[i-1].id);
+        if (i+1 < n) room.addPath(Symbol("e"), dungeon.rooms[i+1].id);
+    }
+}
+
+static void benchDungeon(unsigned int n) {
+    if (strstr("getRoom", filter) == NULL && strstr("getPath", filter) == NULL &&
+        strstr("takeDrop", filter) == NULL && strstr("sweep", filter) == NULL) return;
+    Dungeon dungeon;
+    buildDungeon(dungeon, n);
+
+    unsigned int ops = (n > SAMPLE_OPS) ? SAMPLE_OPS : n;
+    vector<string> ids;
+    unsigned int state = 3;
+    char id[32];
+    for (unsigned int i=0; i<ops; i++) {
+        snprintf(id, sizeof id, "room %u", nextRandom(state) % n);
+        ids.push_back(id);
+    }
+    measure("getRoom", "Dungeon", n, ops, [&]() {
+        unsigned long long found = 0;
+        for (unsigned int i=0; i<ops; i++) {
+            if (dungeon.getRoom(ids[i]) != NULL) found++;
+        }
+        sink += found;
+    });
+
+    Symbol east("e");
+    measure("getPath", "Room", n, n, [&]() {
+        unsigned long long found = 0;
+        for (unsigned int i=0; i<n; i++) {
+            if (dungeon.rooms[i].getPath(east) != NULL) found++;
+        }
+        sink += found;
+    });
+
+    // a pass over every room's visited flag, as a new game sees them
+    WorldOverlay overlay(dungeon);
+    measure("sweep", "WorldOverlay", n, n, [&]() {
+        unsigned long long seen = 0;
+        for (unsigned int i=0; i<n; i++) {
+            if (overlay.visited(i)) seen++;
+        }
+        sink += seen;
+    });
+
+    // n items in the first room; take one and drop it again
+    Symbol room = dungeon.rooms[0].id;
+    vector<Symbol> names;
+    for (unsigned int i=0; i<n; i++) {
+        snprintf(id, sizeof id, "item %u", i);
+        names.push_back(Symbol(id));
+        dungeon.addItem(room, names.back(), "an item");
+    }
+    // the room's list is copied into the game on its first change,
+    // once; make that change before the timing starts
+    WorldOverlay game(dungeon);
+    game.moveItem(names[0], 0, WorldOverlay::INVENTORY);
+    game.moveItem(names[0], WorldOverlay::INVENTORY, 0);
+    measure("takeDrop", "WorldOverlay", n, n, [&]() {
+        unsigned int state = 4;
+        unsigned long long moved = 0;
+        for (unsigned int i=0; i<n; i++) {
+            Symbol name = names[nextRandom(state) % n];
+            if (game.moveItem(name, 0, WorldOverlay::INVENTORY)) moved++;
+            if (game.moveItem(name, WorldOverlay::INVENTORY, 0)) moved++;
+        }
+        sink += moved;
+    });
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int maxSize = 1000000;
+    if (argc > 1) maxSize = strtoul(argv[1], NULL, 10);
+    if (argc > 2) filter = argv[2];
+
+    printf("%-12s %-12s %10s %15s %18s\n", "benchmark", "container", "size", "time", "allocations");
+    for (unsigned long long n=10; n<=maxSize; n*=10) {
+        benchContainer<LinkedList<int> >("LinkedList", n);
+        benchContainer<ArrayList<int> >("ArrayList", n);
+        benchContainer<vector<int> >("std::vector", n);
+        benchContainer<deque<int> >("std::deque", n);
+        benchContainer<list<int> >("std::list", n);
+        benchDungeon(n);
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+    Command.cpp
+
+    This is the implementation file for the command parser.
+
+    The word table is a perfect hash: the compiler tries hash seeds
+    until it finds one that puts every word in its own slot, so a
+    lookup is one hash, one table load and one compare.
+*/
+
+#include "Command.h"
+
+namespace {
+
+struct Word {
+    const char* text;
+    Verb verb;
+    Direction direction;
+};
+
+constexpr Word WORDS[] = {
+    { "go", GO, NUM_DIRECTIONS },
+    { "take", TAKE, NUM_DIRECTIONS },
+    { "drop", DROP, NUM_DIRECTIONS },
+    { "inv", INVENTORY, NUM_DIRECTIONS },
+    { "look", LOOK, NUM_DIRECTIONS },
+    { "help", HELP, NUM_DIRECTIONS },
+    { "quit", QUIT, NUM_DIRECTIONS },
+    { "exit", EXIT, NUM_DIRECTIONS },
+    { "travel", TRAVEL, NUM_DIRECTIONS },
+    { "xyzzy", XYZZY, NUM_DIRECTIONS },
+    { "n", MOVE, NORTH },
+    { "ne", MOVE, NORTHEAST },
+    { "e", MOVE, EAST },
+    { "se", MOVE, SOUTHEAST },
+    { "s", MOVE, SOUTH },
+    { "sw", MOVE, SOUTHWEST },
+    { "w", MOVE, WEST },
+    { "nw", MOVE, NORTHWEST },
+    { "u", MOVE, UP },
+    { "d", MOVE, DOWN },
+    { "north", MOVE, NORTH },
+    { "northeast", MOVE, NORTHEAST },
+    { "east", MOVE, EAST },
+    { "southeast", MOVE, SOUTHEAST },
+    { "south", MOVE, SOUTH },
+    { "southwest", MOVE, SOUTHWEST },
+    { "west", MOVE, WEST },
+    { "northwest", MOVE, NORTHWEST },
+    { "up", MOVE, UP },
+    { "down", MOVE, DOWN }
+};
+constexpr unsigned int WORD_COUNT = sizeof WORDS / sizeof WORDS[0];
+constexpr unsigned int TABLE_SIZE = 128;     // a power of two
+
+constexpr unsigned int length(const char* s) {
+    unsigned int n = 0;
+    while (s[n] != '\0') n++;
+    return n;
+}
+
+// FNV-1a, starting from a seed
+constexpr unsigned int hashWord(const char* s, unsigned int n, unsigned int seed) {
+    unsigned int hash = 2166136261u ^ seed;
+    for (unsigned int i=0; i<n; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct WordTable {
+    unsigned int seed;
+    unsigned char slots[TABLE_SIZE];    // index into WORDS plus one, or 0
+};
+
+// Find the first seed that gives every word a slot of its own
+constexpr WordTable buildTable() {
+    WordTable table = { 0, {} };
+    for (unsigned int seed=0; ; seed++) {
+        for (unsigned int s=0; s<TABLE_SIZE; s++) table.slots[s] = 0;
+        bool perfect = true;
+        for (unsigned int w=0; perfect && w<WORD_COUNT; w++) {
+            unsigned int slot = hashWord(WORDS[w].text, length(WORDS[w].text), seed) & (TABLE_SIZE - 1);
+            if (table.slots[slot] != 0) perfect = false;
+            else table.slots[slot] = w + 1;
+        }
+        if (perfect) {
+            table.seed = seed;
+            return table;
+        }
+    }
+}
+
+constexpr WordTable TABLE = buildTable();
+static_assert(WORD_COUNT < TABLE_SIZE && WORD_COUNT < 255, "the word table is too small");
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+}
+
+Verb CommandParser::verbOf(string_view word, Direction& direction) {
+    unsigned int slot = hashWord(word.data(), word.size(), TABLE.seed) & (TABLE_SIZE - 1);
+    unsigned int w = TABLE.slots[slot];
+    if (w != 0 && word == WORDS[w - 1].text) {
+        direction = WORDS[w - 1].direction;
+        return WORDS[w - 1].verb;
+    }
+    direction = NUM_DIRECTIONS;
+    return MOVE;
+}
+
+Command CommandParser::parse(string_view line) {
+    if (line.size() > MAX_LINE) line = line.substr(0, MAX_LINE);
+    for (unsigned int i=0; i<line.size(); i++) {
+        folded[i] = (line[i] >= 'A' && line[i] <= 'Z') ? line[i] - 'A' + 'a' : line[i];
+    }
+
+    // find the first two words, and count the rest
+    Command command;
+    command.words = 0;
+    string_view words[2];
+    std::size_t restAt = line.size();
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && isSpace(line[i])) i++;
+        if (i == line.size()) break;
+        std::size_t start = i;
+        while (i < line.size() && !isSpace(line[i])) i++;
+        if (command.words < 2) words[command.words] = string_view(folded + start, i - start);
+        if (command.words == 1) restAt = start;
+        command.words++;
+    }
+    std::size_t restEnd = line.size();
+    while (restEnd > restAt && isSpace(line[restEnd - 1])) restEnd--;
+    command.rest = line.substr(restAt, restEnd - restAt);
+
+    command.word = words[0];
+    command.object = words[1];
+    command.verb = verbOf(command.word, command.direction);
+    if (command.verb == GO) {
+        // "go" on its own names no exit, and "go go" names an exit
+        // called "go"; travel needs the rest of the line, which go has used
+        command.word = command.object;
+        command.object = string_view();
+        command.verb = verbOf(command.word, command.direction);
+        if (command.verb == GO || command.verb == TRAVEL) command.verb = MOVE;
+    }
+    return command;
+}
@@ -0,0 +1,56 @@
+/*
+    Command.h
+
+    This is the header file for the command parser. A CommandParser
+    turns a line typed by the player into a Command: the line is split
+    into words and case folded in a fixed buffer, and the first word is
+    looked up in a table of verbs and direction names built when the
+    program is compiled. Parsing a line does no heap allocation.
+*/
+
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+#include "Dungeon.h"
+#include <string_view>
+using std::string_view;
+
+enum Verb {
+    MOVE,           // any word that is not a verb: the name of an exit
+    GO,
+    TAKE,
+    DROP,
+    INVENTORY,
+    LOOK,
+    HELP,
+    QUIT,
+    EXIT,
+    TRAVEL,
+    XYZZY
+};
+
+// A parsed line. The views point into the parser and into the line
+// that was parsed, and are good until the parser's next parse.
+struct Command {
+    Verb verb;
+    Direction direction;    // for MOVE: the standard direction, or NUM_DIRECTIONS
+    string_view word;       // the verb or exit name, case folded
+    string_view object;     // the word after the verb, case folded, or empty
+    string_view rest;       // everything after the first word, as typed
+    unsigned int words;     // number of words on the line
+};
+
+class CommandParser {
+public:
+    static const unsigned int MAX_LINE = 500;
+
+    // Parses one line; only its first MAX_LINE characters are looked at
+    // "go" followed by a word is parsed as that word alone.
+    Command parse(string_view line);
+    // The verb (or MOVE and a direction) a case folded word names
+    static Verb verbOf(string_view word, Direction& direction);
+private:
+    char folded[MAX_LINE];
+};
+
+#endif
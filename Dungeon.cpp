@@ -2,17 +2,36 @@
     Dungeon.cpp
 
     This is the implementation file for a Dungeon object. It also
-    serves as the implementation file for Room, Item, and Path objects.
+    serves as the implementation file for Room, Item, Path and
+    ItemIndex objects.
 */
 
 #include "Dungeon.h"
+#include <utility>
+#include <vector>
 
-Path Path::NULL_PATH("NULL", "NULL");
-Room Room::NULL_ROOM("NULL", "NULL", "NULL");
-Item Item::NULL_ITEM("NULL", "NULL", "NULL");
+// Table from symbol number to Direction. It is built during static
+// initialization, before the data file interns anything, so the
+// direction symbols have small numbers and the table stays small.
+static std::vector<unsigned char> buildDirectionTable() {
+    static const char* names[NUM_DIRECTIONS] = { "n", "ne", "e", "se", "s", "sw", "w", "nw", "u", "d" };
+    std::vector<unsigned char> table;
+    for (unsigned int d=0; d<NUM_DIRECTIONS; d++) {
+        Symbol sym(names[d]);
+        if (sym.id() >= table.size()) table.resize(sym.id() + 1, NUM_DIRECTIONS);
+        table[sym.id()] = d;
+    }
+    return table;
+}
+static const std::vector<unsigned char> directionTable = buildDirectionTable();
+
+Direction directionOf(Symbol dir) {
+    if (dir.id() >= directionTable.size()) return NUM_DIRECTIONS;
+    return static_cast<Direction>(directionTable[dir.id()]);
+}
 
-Path::Path() : direction(""), to("") {}
-Path::Path(string dir, string to) : direction(dir), to(to) {}
+Path::Path() {}
+Path::Path(Symbol dir, Symbol to) : direction(dir), to(to) {}
 bool Path::operator==(const Path& obj) const {
     return direction == obj.direction && to == obj.to;
 }
@@ -20,8 +39,8 @@ bool Path::operator!=(const Path& obj) const {
     return direction != obj.direction || to != obj.to;
 }
 
-Item::Item() : name(""), description(""), location("") {}
-Item::Item(string nm, string desc, string loc) : name(nm), description(desc), location(loc) {}
+Item::Item() : description("") {}
+Item::Item(Symbol nm, string desc, Symbol loc) : name(nm), description(std::move(desc)), location(loc) {}
 bool Item::operator==(const Item& obj) const {
     return name == obj.name && description == obj.description && location == obj.location;
 }
@@ -29,25 +48,223 @@ bool Item::operator!=(const Item& obj) const {
     return name != obj.name || description != obj.description || location != obj.location;
 }
 
-Room::Room() : visited(false), id(""), name(""), description("") {}
-Room::Room(string id, string name, string desc) : visited(false), id(id), name(name), description(desc) {}
-Path& Room::getPath(string dir) {
-    for (unsigned int i=0; i<paths.size(); i++) {
-        if (paths[i].direction == dir) return paths[i];
+Room::Room() : generation(0), pathCount(0) {}
+Room::Room(Symbol id) : generation(0), id(id), pathCount(0) {}
+
+// Add an exit; returns false if the room already has one in that direction
+bool Room::addPath(Symbol dir, Symbol to) {
+    if (getPath(dir) != NULL) return false;
+    Direction d = directionOf(dir);
+    if (d != NUM_DIRECTIONS) exits[d] = Path(dir, to);
+    else customPaths.emplace_back(dir, to);
+    pathCount++;
+    return true;
+}
+
+// Find the exit in a direction; returns NULL if there is none
+// Standard directions are a single table load; only custom direction
+// names are searched for.
+const Path* Room::getPath(Symbol dir) const {
+    Direction d = directionOf(dir);
+    if (d != NUM_DIRECTIONS) {
+        return exits[d].to.empty() ? NULL : &exits[d];
+    }
+    for (const Path& path : customPaths) {
+        if (path.direction == dir) return &path;
     }
-    return Path::NULL_PATH;
+    return NULL;
 }
+
+Path* Room::getPath(Symbol dir) {
+    return const_cast<Path*>(static_cast<const Room*>(this)->getPath(dir));
+}
+// Room ids are unique within a dungeon
 bool Room::operator==(const Room& obj) const {
-    return name == obj.name && description == obj.description && id == obj.id;
+    return id == obj.id;
 }
 bool Room::operator!=(const Room& obj) const {
-    return name != obj.name || description != obj.description || id != obj.id;
+    return id != obj.id;
+}
+
+Dungeon::Dungeon() : index(16), nextGeneration(1) {
+    for (IndexSlot& slot : index) slot.room = EMPTY_SLOT;
 }
 
-Room& Dungeon::getRoom(string id) {
-    for (unsigned int i=0; i<rooms.size(); i++) {
-        if (rooms[i].id == id) return rooms[i];
+// Make room for count rooms in all, so that adding them does not
+// have to grow the room arrays or the id index along the way
+void Dungeon::reserveRooms(unsigned int count) {
+    rooms.reserve(count);
+    if (!pager) {
+        names.reserve(count);
+        descriptions.reserve(count);
     }
-    return Room::NULL_ROOM;
+    if (count * 2 > index.size()) {
+        unsigned int capacity = index.size();
+        while (capacity < count * 2) capacity *= 2;
+        index.assign(capacity, IndexSlot());
+        for (IndexSlot& slot : index) slot.room = EMPTY_SLOT;
+        for (unsigned int i=0; i<rooms.size(); i++) insertIndex(hashId(rooms[i].id), i);
+    }
+}
+
+// Add a new room and record it in the id index
+Room& Dungeon::addRoom(Symbol id, string name, string desc) {
+    unsigned int hash = hashId(id);
+    Room& room = rooms.emplace_back(id);
+    room.generation = nextGeneration++;
+    if (!pager) {
+        names.push_back(std::move(name));
+        descriptions.push_back(std::move(desc));
+    } else if (rooms.size() > pager->roomCount()) {
+        pager->appendRoom(std::move(name), std::move(desc));
+    }
+    if ((rooms.size() * 2) > index.size()) growIndex();
+    else insertIndex(hash, rooms.size() - 1);
+    return room;
+}
+
+// Find a room by id through the index
+// Returns an invalid handle if there is no such room.
+RoomHandle Dungeon::findRoom(Symbol id) const {
+    unsigned int hash = hashId(id);
+    unsigned int mask = index.size() - 1;
+    for (unsigned int i = hash & mask; index[i].room != EMPTY_SLOT; i = (i + 1) & mask) {
+        if (index[i].hash == hash && rooms[index[i].room].id == id) {
+            return RoomHandle(index[i].room, rooms[index[i].room].generation);
+        }
+    }
+    return RoomHandle();
+}
+
+// The room a handle refers to
+// Returns NULL if the handle is invalid or the room has been replaced.
+Room* Dungeon::getRoom(RoomHandle handle) {
+    if (handle.index >= rooms.size()) return NULL;
+    Room& room = rooms[handle.index];
+    return (room.generation == handle.generation) ? &room : NULL;
+}
+
+// Find a room by id; returns NULL if there is no such room
+Room* Dungeon::getRoom(Symbol id) {
+    return getRoom(findRoom(id));
+}
+
+// (Re)build the compact exit graph from the rooms' exits, and start
+// route planning and room rendering over again on the new graph
+void Dungeon::buildGraph() {
+    graph.build(*this);
+    routes.reset(&graph);
+    roomText.clear();
+}
+
+// A room's name, from memory or from its region
+string Dungeon::roomName(unsigned int room) const {
+    if (pager) return pager->name(room);
+    return (room < names.size()) ? names[room] : string();
+}
+
+// A room's description, from memory or from its region
+string Dungeon::roomDescription(unsigned int room) const {
+    if (pager) return pager->description(room);
+    return (room < descriptions.size()) ? descriptions[room] : string();
 }
 
+// Hand the rooms' names and descriptions over to a pager, which the
+// dungeon then owns. Rooms already added must be ones the pager's
+// source knows about; rooms added later are appended to the pager.
+void Dungeon::pageText(RegionPager* newPager) {
+    pager.reset(newPager);
+    names.clear();
+    descriptions.clear();
+}
+
+// Find a room by the text of its id
+Room* Dungeon::getRoom(const string& id) {
+    return getRoom(Symbol::lookup(id));
+}
+
+// Fibonacci hash of a room id's symbol number
+unsigned int Dungeon::hashId(Symbol id) {
+    return id.id() * 2654435769u;
+}
+
+// Put a room into the first free slot at or after its home slot
+void Dungeon::insertIndex(unsigned int hash, unsigned int room) {
+    unsigned int mask = index.size() - 1;
+    unsigned int i = hash & mask;
+    while (index[i].room != EMPTY_SLOT) i = (i + 1) & mask;
+    index[i].hash = hash;
+    index[i].room = room;
+}
+
+// Double the index (keeping it at most half full) and re-insert every room
+void Dungeon::growIndex() {
+    unsigned int capacity = index.size();
+    while (capacity < rooms.size() * 2) capacity *= 2;
+    index.assign(capacity, IndexSlot());
+    for (IndexSlot& slot : index) slot.room = EMPTY_SLOT;
+    for (unsigned int i=0; i<rooms.size(); i++) insertIndex(hashId(rooms[i].id), i);
+}
+
+
+// The item list an owner keeps: the inventory for the empty symbol,
+// otherwise the items of the room with that id
+// Returns NULL if there is no such room.
+LinkedList<Item>* Dungeon::itemsOf(Symbol owner) {
+    if (owner.empty()) return &inventory;
+    Room* room = getRoom(owner);
+    return (room == NULL) ? NULL : &room->items;
+}
+
+// Add a new item at the end of an owner's list
+// Returns NULL if there is no such owner.
+Item* Dungeon::addItem(Symbol owner, Symbol name, string desc) {
+    LinkedList<Item>* items = itemsOf(owner);
+    if (items == NULL) return NULL;
+    items->emplace_back(name, std::move(desc), owner);
+    ItemIndex::ItemRef item = --items->end();
+    itemIndex.add(owner, item);
+    return &*item;
+}
+
+// Find the last item an owner has with the given name
+// Returns NULL if it has none.
+Item* Dungeon::findItem(Symbol owner, Symbol name) {
+    const ItemIndex::ItemRef* item = itemIndex.last(owner, name);
+    return (item == NULL) ? NULL : &**item;
+}
+
+const Item* Dungeon::findItem(Symbol owner, Symbol name) const {
+    const ItemIndex::ItemRef* item = itemIndex.last(owner, name);
+    return (item == NULL) ? NULL : &**item;
+}
+
+// Index key for the items an owner has under one name
+unsigned long long ItemIndex::key(Symbol owner, Symbol name) {
+    return ((unsigned long long)owner.id() << 32) | name.id();
+}
+
+// Record an item as the last one its owner has under its name
+void ItemIndex::add(Symbol owner, ItemRef item) {
+    std::vector<ItemRef>& items = held[key(owner, item->name)];
+    if (items.empty()) byName[item->name.id()].push_back(owner);
+    items.push_back(item);
+}
+
+// The last item an owner has under a name, or NULL if it has none
+const ItemIndex::ItemRef* ItemIndex::last(Symbol owner, Symbol name) const {
+    std::unordered_map<unsigned long long, std::vector<ItemRef> >::const_iterator it = held.find(key(owner, name));
+    return (it == held.end() || it->second.empty()) ? NULL : &it->second.back();
+}
+
+// Every owner that has at least one item with the given name
+const std::vector<Symbol>& ItemIndex::owners(Symbol name) const {
+    static const std::vector<Symbol> none;
+    std::unordered_map<unsigned int, std::vector<Symbol> >::const_iterator it = byName.find(name.id());
+    return (it == byName.end()) ? none : it->second;
+}
+
+void ItemIndex::clear() {
+    held.clear();
+    byName.clear();
+}
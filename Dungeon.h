@@ -2,60 +2,196 @@
     Dungeon.h
 
     This is the header file for a Dungeon object. It also
-    serves as the header file for Room and Path objects.
+    serves as the header file for Room, Path, Item and ItemIndex
+    objects.
+
+    Room ids, directions and item names are Symbols, so they are
+    stored once and compared as integers.
+
+    Lookups return a pointer that is NULL when nothing was found, or a
+    RoomHandle (the room's position in the dungeon plus the generation
+    of the room stored there) that stays usable as the dungeon grows.
 */
 
 #ifndef __DUNGEON_H__
 #define __DUNGEON_H__
 
 #include "LinkedList.h"
+#include "ArrayList.h"
+#include "Symbol.h"
+#include "DungeonGraph.h"
+#include "RoutePlanner.h"
+#include "RoomTextCache.h"
+#include "RegionPager.h"
+#include "Trigger.h"
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 using std::string;
 
+// The standard exit directions, which a Room keeps in a fixed table
+// Exits are listed in this order: clockwise from north, then up and down.
+enum Direction {
+    NORTH, NORTHEAST, EAST, SOUTHEAST,
+    SOUTH, SOUTHWEST, WEST, NORTHWEST,
+    UP, DOWN,
+    NUM_DIRECTIONS
+};
+
+// Returns the Direction a symbol names ("n", "ne", "u", ...), or
+// NUM_DIRECTIONS if it is not one of the standard directions
+Direction directionOf(Symbol dir);
+
 class Path {
 public:
-    string direction;
-    string to;
+    Symbol direction;
+    Symbol to;
     Path();
-    Path(string dir, string to);
+    Path(Symbol dir, Symbol to);
     bool operator==(const Path& obj) const;
     bool operator!=(const Path& obj) const;
-    static Path NULL_PATH;
 };
 
 class Item {
 public:
-    string name;
+    Symbol name;
     string description;
-    string location;
+    Symbol location;
     Item();
-    Item(string name, string description, string location);
+    Item(Symbol name, string description, Symbol location);
     bool operator==(const Item& obj) const;
     bool operator!=(const Item& obj) const;
-    static Item NULL_ITEM;
 };
 
+// A Room holds only what moving around needs. Its name and
+// description are kept by the Dungeon, by room index.
 class Room {
 public:
-    bool visited;
-    string id;
-    string name;
-    string description;
-    LinkedList<Path> paths;
+    unsigned int generation;        // set by Dungeon::addRoom
+    Symbol id;
+    Path exits[NUM_DIRECTIONS];     // indexed by Direction; empty "to" if no exit
+    ArrayList<Path> customPaths;    // exits in any other direction
+    unsigned int pathCount;
     LinkedList<Item> items;
     Room();
-    Room(string id, string name, string desc);
-    Path& getPath(string dir);
+    explicit Room(Symbol id);
+    bool addPath(Symbol dir, Symbol to);
+    Path* getPath(Symbol dir);
+    const Path* getPath(Symbol dir) const;
+    template <typename F>
+    void forEachPath(F visit) const;
     bool operator==(const Room& obj) const;
     bool operator!=(const Room& obj) const;
-    static Room NULL_ROOM;
 };
 
+// Refers to a room by position, so it is not invalidated when the
+// dungeon's room list grows. The generation tells a handle to a room
+// apart from one to a later room put in the same position.
+class RoomHandle {
+public:
+    unsigned int index;
+    unsigned int generation;
+    RoomHandle() : index(NONE), generation(0) {}
+    RoomHandle(unsigned int index, unsigned int generation) : index(index), generation(generation) {}
+    bool valid() const { return index != NONE; }
+    bool operator==(RoomHandle h) const { return index == h.index && generation == h.generation; }
+    bool operator!=(RoomHandle h) const { return index != h.index || generation != h.generation; }
+    static const unsigned int NONE = 0xFFFFFFFFu;
+};
+
+// Calls visit(path) for each exit, standard directions first
+template <typename F>
+void Room::forEachPath(F visit) const {
+    for (unsigned int d=0; d<NUM_DIRECTIONS; d++) {
+        if (!exits[d].to.empty()) visit(exits[d]);
+    }
+    for (const Path& path : customPaths) visit(path);
+}
+
+// Finds the items an owner (a room id, or the empty symbol for items
+// the player carries) has under a name, in the order they appear in
+// the owner's list, and the owners that have an item with a name. The
+// base world's items never move; each game moves them in its own
+// WorldOverlay, which keeps the same index for the owners it changes.
+class ItemIndex {
+public:
+    typedef LinkedList<Item>::iterator ItemRef;
+    void add(Symbol owner, ItemRef item);
+    const ItemRef* last(Symbol owner, Symbol name) const;
+    const std::vector<Symbol>& owners(Symbol name) const;
+    void clear();
+private:
+    static unsigned long long key(Symbol owner, Symbol name);
+    std::unordered_map<unsigned long long, std::vector<ItemRef> > held;
+    std::unordered_map<unsigned int, std::vector<Symbol> > byName;
+};
+
+// Rooms must be added through addRoom so that getRoom can find them
+// through the id index. A room's id must not change once it is added.
+//
+// Room data is split by how often it is used: rooms holds the ids and
+// exits, and names and descriptions are kept apart so that walking
+// over the rooms does not read any text.
+// All of these are indexed by room index (RoomHandle::index).
+//
+// Names and descriptions are read through roomName and
+// roomDescription. Normally they are all in memory; after pageText
+// they are kept by a RegionPager instead, which holds only the
+// regions in use. Nothing else is paged: the rooms, their exits and
+// items, the graph and the id index stay in memory.
+//
+// graph is a compact copy of the exits, built by buildGraph once the
+// data file is loaded. It must be rebuilt whenever an exit changes.
+// routes plans travel over graph and is reset along with it, as is
+// roomText, the rendered text of rooms that games share.
+//
+// triggers are the scripted events declared in the data file. The
+// Dungeon only keeps them; each game runs them against its own world.
+//
+// Items must be added through addItem so that itemIndex stays
+// consistent with the rooms' item lists and the player's inventory.
 class Dungeon {
 public:
-    LinkedList<Room> rooms;
-    string currentRoom;
-    Room& getRoom(string id);
+    ArrayList<Room> rooms;
+    Symbol currentRoom;
+    DungeonGraph graph;
+    RoutePlanner routes;
+    RoomTextCache roomText;
+    TriggerTable triggers;
+    LinkedList<Item> inventory;
+    ItemIndex itemIndex;
+    Dungeon();
+    void reserveRooms(unsigned int count);
+    Room& addRoom(Symbol id, string name, string desc);
+    RoomHandle findRoom(Symbol id) const;
+    Room* getRoom(RoomHandle handle);
+    Room* getRoom(Symbol id);
+    Room* getRoom(const string& id);
+    string roomName(unsigned int room) const;
+    string roomDescription(unsigned int room) const;
+    void pageText(RegionPager* pager);
+    RegionPager* textPager() const { return pager.get(); }
+    void buildGraph();
+    LinkedList<Item>* itemsOf(Symbol owner);
+    Item* addItem(Symbol owner, Symbol name, string desc);
+    Item* findItem(Symbol owner, Symbol name);
+    const Item* findItem(Symbol owner, Symbol name) const;
+private:
+    // open addressing (linear probing) table from room id to room index
+    struct IndexSlot {
+        unsigned int hash;
+        unsigned int room;  // index into rooms, or EMPTY_SLOT
+    };
+    static const unsigned int EMPTY_SLOT = 0xFFFFFFFFu;
+    std::vector<IndexSlot> index;
+    unsigned int nextGeneration;
+    ArrayList<string> names;
+    ArrayList<string> descriptions;
+    std::unique_ptr<RegionPager> pager;
+    static unsigned int hashId(Symbol id);
+    void insertIndex(unsigned int hash, unsigned int room);
+    void growIndex();
 };
 
 #endif
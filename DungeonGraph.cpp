@@ -0,0 +1,94 @@
+/*
+    DungeonGraph.cpp
+
+    This is the implementation file for a DungeonGraph object.
+*/
+
+#include "DungeonGraph.h"
+#include "Dungeon.h"
+#include <algorithm>
+
+// Lay out every room's exits one after another. Exits that lead to
+// an unknown room are kept, with NO_TARGET as their destination.
+void DungeonGraph::build(const Dungeon& dungeon) {
+    unsigned int rooms = dungeon.rooms.size();
+    unsigned int edges = 0;
+    for (const Room& room : dungeon.rooms) edges += room.pathCount;
+
+    offsets.assign(rooms + 1, 0);
+    targets.clear();
+    directions.clear();
+    targets.reserve(edges);
+    directions.reserve(edges);
+    for (unsigned int r=0; r<rooms; r++) {
+        offsets[r] = targets.size();
+        dungeon.rooms[r].forEachPath([&](const Path& path) {
+            unsigned int to = NO_TARGET;
+            RoomHandle room = dungeon.findRoom(path.to);
+            if (room.valid()) to = room.index;
+            targets.push_back(to);
+            directions.push_back(path.direction);
+        });
+    }
+    offsets[rooms] = targets.size();
+}
+
+unsigned int DungeonGraph::roomCount() const {
+    return offsets.empty() ? 0 : offsets.size() - 1;
+}
+
+unsigned int DungeonGraph::edgeCount() const {
+    return targets.size();
+}
+
+// Breadth-first search from one room; returns how many rooms can be
+// reached from it, counting the room itself
+unsigned int DungeonGraph::countReachable(unsigned int from) const {
+    if (from >= roomCount()) return 0;
+    std::vector<bool> seen(roomCount(), false);
+    std::vector<unsigned int> queue;
+    queue.reserve(roomCount());
+    queue.push_back(from);
+    seen[from] = true;
+    for (unsigned int head=0; head<queue.size(); head++) {
+        unsigned int r = queue[head];
+        for (unsigned int e=offsets[r]; e<offsets[r+1]; e++) {
+            unsigned int to = targets[e];
+            if (to != NO_TARGET && !seen[to]) {
+                seen[to] = true;
+                queue.push_back(to);
+            }
+        }
+    }
+    return queue.size();
+}
+
+SearchScratch::SearchScratch() : epoch(0) {}
+
+// Get ready for a search over a graph of the given size
+void SearchScratch::start(unsigned int rooms) {
+    if (stamps.size() < rooms) {
+        stamps.resize(rooms, 0);
+        from.resize(rooms);
+        via.resize(rooms);
+        distance.resize(rooms);
+    }
+    queue.clear();
+    if (++epoch == 0) {
+        // the epoch wrapped, so old stamps could match it again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+    }
+}
+
+void SearchScratch::visit(unsigned int room, unsigned int cameFrom, unsigned int cameVia) {
+    stamps[room] = epoch;
+    from[room] = cameFrom;
+    via[room] = cameVia;
+    distance[room] = (room == cameFrom) ? 0 : distance[cameFrom] + 1;
+}
+
+SearchScratch& SearchScratch::local() {
+    thread_local SearchScratch scratch;
+    return scratch;
+}
@@ -0,0 +1,53 @@
+/*
+    DungeonGraph.h
+
+    This is the header file for a DungeonGraph object. A DungeonGraph
+    is a frozen, compressed sparse row copy of a Dungeon's exits: the
+    exits of room r are entries offsets[r] up to offsets[r+1] of the
+    flat targets and directions arrays, and rooms are referred to by
+    their position in Dungeon::rooms. Traversals over it touch only
+    these arrays, never the rooms or the id index.
+*/
+
+#ifndef __DUNGEON_GRAPH_H__
+#define __DUNGEON_GRAPH_H__
+
+#include "Symbol.h"
+#include <vector>
+
+class Dungeon;
+
+class DungeonGraph {
+public:
+    std::vector<unsigned int> offsets;   // rooms + 1 entries
+    std::vector<unsigned int> targets;   // room index, or NO_TARGET
+    std::vector<Symbol> directions;
+    void build(const Dungeon& dungeon);
+    unsigned int roomCount() const;
+    unsigned int edgeCount() const;
+    unsigned int countReachable(unsigned int from) const;
+    static const unsigned int NO_TARGET = 0xFFFFFFFFu;
+};
+
+// Per-room working arrays for a breadth-first search, kept between
+// searches so that a search allocates nothing once they have grown.
+// A room counts as visited only if it was visited since the last
+// start, so starting a search clears every mark at once.
+class SearchScratch {
+public:
+    SearchScratch();
+    std::vector<unsigned int> from;     // room each visited room was reached from
+    std::vector<unsigned int> via;      // and the exit taken to reach it
+    std::vector<unsigned int> distance; // and how many exits from the start
+    std::vector<unsigned int> queue;
+    void start(unsigned int rooms);
+    bool visited(unsigned int room) const { return stamps[room] == epoch; }
+    void visit(unsigned int room, unsigned int cameFrom, unsigned int cameVia);
+    // The scratch of the calling thread
+    static SearchScratch& local();
+private:
+    std::vector<unsigned int> stamps;   // epoch of the search that last visited each room
+    unsigned int epoch;
+};
+
+#endif
@@ -0,0 +1,249 @@
+/*
+    DungeonImage.cpp
+
+    This is the implementation file for compiled dungeon images.
+
+    Layout, in file order (numbers are in the machine's byte order):
+        Header
+        uint64_t stringOffsets[stringCount + 1]
+        char     stringBytes[stringBytes], padded to a multiple of 8
+        RoomRecord rooms[roomCount]
+        EdgeRecord edges[edgeCount]
+        ItemRecord items[itemCount]
+*/
+
+#include "DungeonImage.h"
+#include "DungeonLoader.h"
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <vector>
+using std::ofstream;
+
+static const char MAGIC[8] = { 'D', 'U', 'N', 'G', 'E', 'O', 'N', '\0' };
+
+// 64-bit FNV-1a, taken a word at a time so that checking a large data
+// file stays much cheaper than parsing it
+uint64_t DungeonImage::checksum(string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    std::size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, text.data() + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; i < text.size(); i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ull;
+    }
+    return hash ^ text.size();
+}
+
+string DungeonImage::imageName(const char* dataFile) {
+    return string(dataFile) + ".bin";
+}
+
+// Round up to a multiple of 8
+static uint64_t padded(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+void DungeonImage::write(const Dungeon& dungeon, const char* filename, uint64_t checksum) {
+    // number every distinct string; room text is copied into text
+    // so that the views stay valid
+    std::deque<string> text;
+    std::vector<string_view> strings;
+    std::unordered_map<string_view, uint32_t> numbers;
+    uint64_t stringBytes = 0;
+    auto number = [&](string_view s) -> uint32_t {
+        std::unordered_map<string_view, uint32_t>::iterator it = numbers.find(s);
+        if (it != numbers.end()) return it->second;
+        uint32_t n = strings.size();
+        numbers.emplace(s, n);
+        strings.push_back(s);
+        stringBytes += s.size();
+        return n;
+    };
+
+    std::vector<RoomRecord> rooms;
+    std::vector<EdgeRecord> edges;
+    std::vector<ItemRecord> items;
+    rooms.reserve(dungeon.rooms.size());
+    for (unsigned int r=0; r<dungeon.rooms.size(); r++) {
+        const Room& room = dungeon.rooms[r];
+        RoomRecord record;
+        record.id = number(room.id.str());
+        text.push_back(dungeon.roomName(r));
+        record.name = number(text.back());
+        text.push_back(dungeon.roomDescription(r));
+        record.description = number(text.back());
+        record.firstEdge = edges.size();
+        record.firstItem = items.size();
+        rooms.push_back(record);
+        room.forEachPath([&](const Path& path) {
+            EdgeRecord edge;
+            edge.direction = number(path.direction.str());
+            edge.to = number(path.to.str());
+            edges.push_back(edge);
+        });
+        for (const Item& item : room.items) {
+            ItemRecord record;
+            record.name = number(item.name.str());
+            record.description = number(item.description);
+            items.push_back(record);
+        }
+    }
+
+    uint32_t triggers = NONE;
+    if (!dungeon.triggers.empty()) {
+        text.push_back(dungeon.triggers.records());
+        triggers = number(text.back());
+    }
+
+    Header header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, MAGIC, sizeof MAGIC);
+    header.version = VERSION;
+    header.initRoom = dungeon.currentRoom.empty() ? NONE : number(dungeon.currentRoom.str());
+    header.checksum = checksum;
+    header.stringCount = strings.size();
+    header.roomCount = rooms.size();
+    header.edgeCount = edges.size();
+    header.itemCount = items.size();
+    header.triggers = triggers;
+    header.stringBytes = stringBytes;
+
+    std::vector<uint64_t> offsets;
+    offsets.reserve(strings.size() + 1);
+    uint64_t offset = 0;
+    for (string_view s : strings) {
+        offsets.push_back(offset);
+        offset += s.size();
+    }
+    offsets.push_back(offset);
+
+    // write to a temporary name so a reader never sees half an image
+    string temp = string(filename) + ".tmp";
+    ofstream ofile(temp.c_str(), std::ios::binary | std::ios::trunc);
+    if (!ofile) {
+        throw string("Error: Could not write dungeon image");
+    }
+    static const char zeros[8] = { 0 };
+    ofile.write(reinterpret_cast<const char*>(&header), sizeof header);
+    ofile.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for (string_view s : strings) ofile.write(s.data(), s.size());
+    ofile.write(zeros, padded(stringBytes) - stringBytes);
+    ofile.write(reinterpret_cast<const char*>(rooms.data()), rooms.size() * sizeof(RoomRecord));
+    ofile.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(EdgeRecord));
+    ofile.write(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(ItemRecord));
+    ofile.close();
+    if (!ofile || rename(temp.c_str(), filename) != 0) {
+        remove(temp.c_str());
+        throw string("Error: Could not write dungeon image");
+    }
+}
+
+DungeonImage::Status DungeonImage::load(Dungeon& dungeon, const char* filename, uint64_t checksum,
+                                        std::size_t textBudget) {
+    struct stat info;
+    if (stat(filename, &info) != 0) return MISSING;
+    try {
+        // a pager reads room text from the mapping for as long as the dungeon lasts
+        std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(filename);
+        string_view image = file->text();
+
+        // check the header and that every table fits in the file
+        Header header;
+        if (image.size() < sizeof header) return STALE;
+        memcpy(&header, image.data(), sizeof header);
+        if (memcmp(header.magic, MAGIC, sizeof MAGIC) != 0 || header.version != VERSION ||
+            header.checksum != checksum) return STALE;
+        uint64_t offsetsAt = sizeof(Header);
+        uint64_t bytesAt = offsetsAt + ((uint64_t)header.stringCount + 1) * sizeof(uint64_t);
+        uint64_t roomsAt = bytesAt + padded(header.stringBytes);
+        uint64_t edgesAt = roomsAt + (uint64_t)header.roomCount * sizeof(RoomRecord);
+        uint64_t itemsAt = edgesAt + (uint64_t)header.edgeCount * sizeof(EdgeRecord);
+        uint64_t end = itemsAt + (uint64_t)header.itemCount * sizeof(ItemRecord);
+        if (header.stringBytes > image.size() || end != image.size()) return STALE;
+
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(image.data() + offsetsAt);
+        const char* bytes = image.data() + bytesAt;
+        const RoomRecord* rooms = reinterpret_cast<const RoomRecord*>(image.data() + roomsAt);
+        const EdgeRecord* edges = reinterpret_cast<const EdgeRecord*>(image.data() + edgesAt);
+        const ItemRecord* items = reinterpret_cast<const ItemRecord*>(image.data() + itemsAt);
+
+        // check every reference before changing the dungeon
+        uint32_t strings = header.stringCount;
+        if (offsets[0] != 0 || offsets[strings] != header.stringBytes) return STALE;
+        for (uint32_t s=0; s<strings; s++) {
+            if (offsets[s] > offsets[s+1]) return STALE;
+        }
+        if (header.initRoom != NONE && header.initRoom >= strings) return STALE;
+        if (header.triggers != NONE && header.triggers >= strings) return STALE;
+        for (uint32_t r=0; r<header.roomCount; r++) {
+            uint32_t lastEdge = (r+1 < header.roomCount) ? rooms[r+1].firstEdge : header.edgeCount;
+            uint32_t lastItem = (r+1 < header.roomCount) ? rooms[r+1].firstItem : header.itemCount;
+            if (rooms[r].id >= strings || rooms[r].name >= strings || rooms[r].description >= strings ||
+                rooms[r].firstEdge > lastEdge || lastEdge > header.edgeCount ||
+                rooms[r].firstItem > lastItem || lastItem > header.itemCount) return STALE;
+        }
+        if (header.roomCount > 0 && (rooms[0].firstEdge != 0 || rooms[0].firstItem != 0)) return STALE;
+        for (uint32_t e=0; e<header.edgeCount; e++) {
+            if (edges[e].direction >= strings || edges[e].to >= strings) return STALE;
+        }
+        for (uint32_t i=0; i<header.itemCount; i++) {
+            if (items[i].name >= strings || items[i].description >= strings) return STALE;
+        }
+
+        // build the dungeon, interning each string that names something once
+        std::vector<Symbol> symbols(strings);
+        std::vector<bool> interned(strings, false);
+        auto text = [&](uint32_t s) {
+            return string_view(bytes + offsets[s], offsets[s+1] - offsets[s]);
+        };
+        auto symbol = [&](uint32_t s) {
+            if (!interned[s]) {
+                symbols[s] = Symbol(text(s));
+                interned[s] = true;
+            }
+            return symbols[s];
+        };
+        TriggerTable triggers;
+        if (header.triggers != NONE) parseTriggers(triggers, text(header.triggers));
+
+        bool paged = (textBudget > 0);
+        if (paged) {
+            RegionPager::Source source = [file, offsets, bytes, rooms](unsigned int r, string& name, string& desc) {
+                name.assign(bytes + offsets[rooms[r].name], offsets[rooms[r].name + 1] - offsets[rooms[r].name]);
+                desc.assign(bytes + offsets[rooms[r].description],
+                            offsets[rooms[r].description + 1] - offsets[rooms[r].description]);
+            };
+            dungeon.pageText(new RegionPager(header.roomCount, source, textBudget));
+        }
+        dungeon.reserveRooms(header.roomCount);
+        for (uint32_t r=0; r<header.roomCount; r++) {
+            uint32_t lastEdge = (r+1 < header.roomCount) ? rooms[r+1].firstEdge : header.edgeCount;
+            uint32_t lastItem = (r+1 < header.roomCount) ? rooms[r+1].firstItem : header.itemCount;
+            Room& room = paged ? dungeon.addRoom(symbol(rooms[r].id), string(), string())
+                               : dungeon.addRoom(symbol(rooms[r].id), string(text(rooms[r].name)),
+                                                 string(text(rooms[r].description)));
+            for (uint32_t e=rooms[r].firstEdge; e<lastEdge; e++) {
+                room.addPath(symbol(edges[e].direction), symbol(edges[e].to));
+            }
+            Symbol id = room.id;
+            for (uint32_t i=rooms[r].firstItem; i<lastItem; i++) {
+                dungeon.addItem(id, symbol(items[i].name), string(text(items[i].description)));
+            }
+        }
+        if (header.initRoom != NONE) dungeon.currentRoom = symbol(header.initRoom);
+        dungeon.triggers = std::move(triggers);
+        return LOADED;
+    } catch (string msg) {
+        return STALE;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+    DungeonImage.h
+
+    This is the header file for compiled dungeon images. An image is a
+    binary copy of a loaded dungeon that can be read back without
+    parsing the text data file it came from.
+
+    An image holds a header, a string table (every distinct string
+    once), a room table, an edge (path) table and an item table. Rooms
+    refer to strings by number and to their edges and items by the
+    position of the first one. Triggers, which are few, are kept as the
+    text of their data file records, in the string table. The header
+    records the format version and a checksum of the source text, so
+    an image whose source has changed is recognized as stale.
+*/
+
+#ifndef __DUNGEON_IMAGE_H__
+#define __DUNGEON_IMAGE_H__
+
+#include "Dungeon.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+using std::string;
+using std::string_view;
+
+class DungeonImage {
+public:
+    enum Status {
+        MISSING,    // there is no image file
+        STALE,      // the image is for other source text, another version, or damaged
+        LOADED
+    };
+    static const uint32_t VERSION = 2;
+
+    // Checksum of a data file's text, as recorded in its image
+    static uint64_t checksum(string_view text);
+    // Load an image made from source text with the given checksum into
+    // an empty dungeon; the dungeon is not changed unless it returns LOADED
+    // If textBudget is not 0, room names and descriptions are left in the
+    // image and paged in by region, keeping about that many bytes of them.
+    static Status load(Dungeon& dungeon, const char* filename, uint64_t checksum,
+                       std::size_t textBudget = 0);
+    // Write an image of dungeon, made from source text with the given checksum
+    // This will throw an exception if the file cannot be written.
+    static void write(const Dungeon& dungeon, const char* filename, uint64_t checksum);
+    // The name of the image kept for a data file
+    static string imageName(const char* dataFile);
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t initRoom;          // string number, or NONE
+        uint64_t checksum;
+        uint32_t stringCount;
+        uint32_t roomCount;
+        uint32_t edgeCount;
+        uint32_t itemCount;
+        uint64_t stringBytes;
+        uint32_t triggers;          // string number of the trigger records, or NONE
+        uint32_t unused;
+    };
+    struct RoomRecord {
+        uint32_t id;
+        uint32_t name;
+        uint32_t description;
+        uint32_t firstEdge;
+        uint32_t firstItem;
+    };
+    struct EdgeRecord {
+        uint32_t direction;
+        uint32_t to;
+    };
+    struct ItemRecord {
+        uint32_t name;
+        uint32_t description;
+    };
+    static const uint32_t NONE = 0xFFFFFFFFu;
+};
+
+#endif
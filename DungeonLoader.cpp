@@ -0,0 +1,559 @@
+/*
+    DungeonLoader.cpp
+
+    This is the implementation file for the dungeon data file loader.
+
+    A data file is a series of records. Each record starts on a line
+    beginning with ROOM:, PATH:, ITEM:, INIT:, WHEN: or THEN: and runs
+    up to the next such line; the lines in between continue its last
+    field. Anything before the first record is ignored.
+
+    WHEN: and THEN: records declare triggers (see Trigger.h):
+        WHEN:event:room:item:conditions
+        THEN:action:arguments
+    The event is drop, take or xyzzy, and room or item may be * for
+    any (xyzzy has no item, so its item is always *). The conditions,
+    which may be left off, are "here item" or "carrying item",
+    separated by commas. The THEN records after one or more WHEN
+    records are the actions of each of them:
+        THEN:say:text
+        THEN:remove:item
+        THEN:path:direction:room:destination
+        THEN:replace:room:old text:new text
+        THEN:describe:room:text
+        THEN:teleport:room
+    When an event happens, the first trigger declared for it whose
+    conditions hold carries out its actions.
+*/
+
+#include "DungeonLoader.h"
+#include "DungeonImage.h"
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+MappedFile::MappedFile(const char* filename) : data(NULL), length(0), mapped(false) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        throw string("Error: Could not open data file");
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* p = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, info.st_size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(p);
+            length = info.st_size;
+            mapped = true;
+        }
+    }
+    if (!mapped) {
+        char chunk[65536];
+        ssize_t n;
+        while ((n = read(fd, chunk, sizeof chunk)) > 0) buffer.append(chunk, n);
+        if (n < 0) {
+            close(fd);
+            throw string("Error: Problem reading data file");
+        }
+        data = buffer.data();
+        length = buffer.size();
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mapped) munmap(const_cast<char*>(data), length);
+}
+
+// Files smaller than this are parsed on one thread
+static const std::size_t PARALLEL_MIN_BYTES = 1 << 20;
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// eliminates spaces from beginning and end of a slice
+static string_view trim(string_view src) {
+    std::size_t first = 0;
+    std::size_t last = src.size();
+    while (first < last && isSpace(src[first])) first++;
+    while (last > first && isSpace(src[last-1])) last--;
+    return src.substr(first, last - first);
+}
+
+// true if a line starts a new record
+static bool startsRecord(string_view line) {
+    string_view start = line.substr(0, 5);
+    return start == "ROOM:" || start == "PATH:" || start == "INIT:" || start == "ITEM:" ||
+           start == "WHEN:" || start == "THEN:";
+}
+
+// The text of a field: each of its lines trimmed, and the lines joined
+// by single spaces. A field that fits on one line is returned as a
+// slice of the record; a longer one is joined into scratch.
+static string_view fieldText(string_view raw, string& scratch) {
+    raw = trim(raw);
+    if (raw.find('\n') == string_view::npos) return raw;
+    scratch.clear();
+    std::size_t pos = 0;
+    while (pos <= raw.size()) {
+        std::size_t end = raw.find('\n', pos);
+        if (end == string_view::npos) end = raw.size();
+        string_view piece = trim(raw.substr(pos, end - pos));
+        if (!piece.empty()) {
+            if (!scratch.empty()) scratch += ' ';
+            scratch.append(piece);
+        }
+        pos = end + 1;
+    }
+    return scratch;
+}
+
+// Split a ROOM, PATH or ITEM record into its three fields
+// Returns false if the record does not have them all.
+static bool splitFields(string_view record, string_view fields[3], string scratch[3]) {
+    std::size_t pos1 = 4;
+    std::size_t pos2 = record.find(':', pos1+1);
+    if (pos2 == string_view::npos) return false;
+    std::size_t pos3 = record.find(':', pos2+1);
+    if (pos3 == string_view::npos) return false;
+    fields[0] = fieldText(record.substr(pos1+1, pos2-pos1-1), scratch[0]);
+    fields[1] = fieldText(record.substr(pos2+1, pos3-pos2-1), scratch[1]);
+    fields[2] = fieldText(record.substr(pos3+1), scratch[2]);
+    return true;
+}
+
+// Split text at its colons into at most count fields; the last field
+// runs to the end of the text. Returns the number of fields found.
+static unsigned int splitAt(string_view text, unsigned int count, string_view fields[], string scratch[]) {
+    unsigned int n = 0;
+    while (n+1 < count) {
+        std::size_t colon = text.find(':');
+        if (colon == string_view::npos) break;
+        fields[n] = fieldText(text.substr(0, colon), scratch[n]);
+        text = text.substr(colon+1);
+        n++;
+    }
+    fields[n] = fieldText(text, scratch[n]);
+    return n+1;
+}
+
+// The actions a THEN record may give, and how many fields each takes
+static const struct {
+    const char* name;
+    TriggerAction::Kind kind;
+    unsigned int fields;
+} TRIGGER_ACTIONS[] = {
+    { "say", TriggerAction::SAY, 1 },
+    { "remove", TriggerAction::REMOVE, 1 },
+    { "path", TriggerAction::PATH, 3 },
+    { "replace", TriggerAction::REPLACE, 3 },
+    { "describe", TriggerAction::DESCRIBE, 2 },
+    { "teleport", TriggerAction::TELEPORT, 1 }
+};
+
+// routine to process a WHEN or THEN record of a dungeon data file
+// this will throw an exception if it has any problems
+static void processTrigger(TriggerTable& triggers, string_view record, string scratch[4]) {
+    string_view fields[4];
+    if (record.substr(0, 5) == "WHEN:") {
+        unsigned int n = splitAt(record.substr(5), 4, fields, scratch);
+        if (n < 3) {
+            throw string("Error: Problem parsing trigger in data file");
+        }
+        unsigned int event = 0;
+        while (event < NUM_TRIGGER_EVENTS && fields[0] != TriggerTable::EVENT_NAMES[event]) event++;
+        if (event == NUM_TRIGGER_EVENTS) {
+            throw string("Error: Unknown trigger event in data file");
+        }
+        Symbol room = (fields[1] == "*") ? Symbol() : Symbol(fields[1]);
+        if (event == ON_XYZZY && fields[2] != "*") {
+            throw string("Error: Trigger for xyzzy names an item in data file");
+        }
+        Symbol item = (fields[2] == "*") ? Symbol() : Symbol(fields[2]);
+        Trigger& trigger = triggers.add((TriggerEvent)event, room, item);
+        string_view conditions = (n == 4) ? fields[3] : string_view();
+        while (!conditions.empty()) {
+            std::size_t comma = conditions.find(',');
+            string_view text = trim(conditions.substr(0, comma));
+            conditions = (comma == string_view::npos) ? string_view() : conditions.substr(comma+1);
+            TriggerCondition condition;
+            if (text.substr(0, 5) == "here ") {
+                condition.kind = TriggerCondition::HERE;
+                condition.item = Symbol(trim(text.substr(5)));
+            } else if (text.substr(0, 9) == "carrying ") {
+                condition.kind = TriggerCondition::CARRYING;
+                condition.item = Symbol(trim(text.substr(9)));
+            } else {
+                throw string("Error: Unknown trigger condition in data file");
+            }
+            trigger.conditions.push_back(condition);
+        }
+    } else { // record must start with "THEN:"
+        if (triggers.empty()) {
+            throw string("Error: Trigger action before any trigger in data file");
+        }
+        string_view body = record.substr(5);
+        std::size_t colon = body.find(':');
+        if (colon == string_view::npos) {
+            throw string("Error: Problem parsing trigger in data file");
+        }
+        string_view name = trim(body.substr(0, colon));
+        unsigned int a = 0;
+        unsigned int actions = sizeof TRIGGER_ACTIONS / sizeof TRIGGER_ACTIONS[0];
+        while (a < actions && name != TRIGGER_ACTIONS[a].name) a++;
+        if (a == actions) {
+            throw string("Error: Unknown trigger action in data file");
+        }
+        if (splitAt(body.substr(colon+1), TRIGGER_ACTIONS[a].fields, fields, scratch) < TRIGGER_ACTIONS[a].fields) {
+            throw string("Error: Problem parsing trigger in data file");
+        }
+        TriggerAction action;
+        action.kind = TRIGGER_ACTIONS[a].kind;
+        switch (action.kind) {
+        case TriggerAction::SAY:
+            action.text = fields[0];
+            break;
+        case TriggerAction::REMOVE:
+            action.item = Symbol(fields[0]);
+            break;
+        case TriggerAction::PATH:
+            action.direction = Symbol(fields[0]);
+            action.room = Symbol(fields[1]);
+            action.to = Symbol(fields[2]);
+            break;
+        case TriggerAction::REPLACE:
+            action.room = Symbol(fields[0]);
+            action.text = fields[1];
+            action.replacement = fields[2];
+            break;
+        case TriggerAction::DESCRIBE:
+            action.room = Symbol(fields[0]);
+            action.text = fields[1];
+            break;
+        case TriggerAction::TELEPORT:
+            action.room = Symbol(fields[0]);
+            break;
+        }
+        triggers.addAction(action);
+    }
+}
+
+// Make sure every room the triggers are in or act on exists
+// Exits added by triggers may lead anywhere, as those in PATH records may.
+// this will throw an exception if it finds an unknown room
+static void checkTriggers(const Dungeon& dungeon) {
+    for (const Trigger& trigger : dungeon.triggers) {
+        if (!trigger.room.empty() && !dungeon.findRoom(trigger.room).valid()) {
+            throw string("Error: Trigger in unknown room");
+        }
+        for (const TriggerAction& action : trigger.actions) {
+            if (!action.room.empty() && !dungeon.findRoom(action.room).valid()) {
+                throw string("Error: Trigger acts on unknown room");
+            }
+        }
+    }
+}
+
+// routine to process one record of a dungeon data file
+// this will throw an exception if it has any problems
+static void processRecord(Dungeon& dungeon, string_view record, string scratch[4]) {
+    string_view start = record.substr(0, 5);
+    if (start == "ROOM:" || start == "PATH:" || start == "ITEM:") {
+        string_view fields[3];
+        if (!splitFields(record, fields, scratch)) {
+            throw string("Error: Problem parsing data file");
+        }
+        if (start == "ROOM:") {
+            Symbol id(fields[0]);
+            if (dungeon.findRoom(id).valid()) {
+                throw string("Error: Duplicate room ID found in input file");
+            }
+            dungeon.addRoom(id, string(fields[1]), string(fields[2]));
+        } else if (start == "PATH:") {
+            Room* room = dungeon.getRoom(Symbol::lookup(fields[1]));
+            if (room == NULL) {
+                throw string("Error: Path from unknown room encountered in input file");
+            }
+            if (!room->addPath(Symbol(fields[0]), Symbol(fields[2]))) {
+                throw string("Error: Duplicate path source encountered in input file");
+            }
+        } else { // start must be "ITEM:"
+            Room* room = dungeon.getRoom(Symbol::lookup(fields[2]));
+            if (room == NULL) {
+                throw string("Error: Item placed in unknown room");
+            }
+            dungeon.addItem(room->id, Symbol(fields[0]), string(fields[1]));
+        }
+    } else if (start == "INIT:") {
+        dungeon.currentRoom = Symbol(fieldText(record.substr(5), scratch[1]));
+    } else if (start == "WHEN:" || start == "THEN:") {
+        processTrigger(dungeon.triggers, record, scratch);
+    }
+}
+
+// Calls visit(record) for each record of the text, in order
+template <typename F>
+static void forEachRecord(string_view text, F visit) {
+    std::size_t recordStart = 0;
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        std::size_t end = text.find('\n', pos);
+        if (end == string_view::npos) end = text.size();
+        if (pos > recordStart && startsRecord(text.substr(pos, end - pos))) {
+            visit(text.substr(recordStart, pos - recordStart));
+            recordStart = pos;
+        }
+        pos = end + 1;
+    }
+    visit(text.substr(recordStart));
+}
+
+void parseTriggers(TriggerTable& triggers, string_view text) {
+    string scratch[4];
+    forEachRecord(text, [&](string_view record) {
+        string_view start = record.substr(0, 5);
+        if (start == "WHEN:" || start == "THEN:") processTrigger(triggers, record, scratch);
+    });
+}
+
+// Split the text into records and process them in order
+void parseDungeon(Dungeon& dungeon, string_view text) {
+    string scratch[4];
+    forEachRecord(text, [&](string_view record) {
+        processRecord(dungeon, record, scratch);
+    });
+    checkTriggers(dungeon);
+}
+
+// A record parsed by a worker thread, waiting to be added to the dungeon
+struct ParsedRecord {
+    char type;                  // 'R'oom, 'P'ath, 'I'tem, i'N'it, or 'W'hen/then
+    unsigned long long ordinal; // position of the record in the file
+    Symbol symbol1;             // ROOM: id; PATH: direction; ITEM: name; INIT: room
+    Symbol symbol2;             // PATH: destination
+    Symbol place;               // PATH: source room; ITEM: room
+    string text1;               // ROOM: name; ITEM: description; WHEN/THEN: the record
+    string text2;               // ROOM: description
+    unsigned int room;          // index of place, once resolved
+};
+
+// The records of one chunk of the file, and the first error in it
+struct ParsedChunk {
+    std::vector<ParsedRecord> records;
+    unsigned long long errorAt;
+    string error;
+    ParsedChunk() : errorAt(NO_ERROR) {}
+    static const unsigned long long NO_ERROR = ~0ull;
+};
+
+// Keep an error if it comes before any found so far
+static void noteError(ParsedChunk& chunk, unsigned long long ordinal, const char* error) {
+    if (ordinal < chunk.errorAt) {
+        chunk.errorAt = ordinal;
+        chunk.error = error;
+    }
+}
+
+// The first record start at or after pos
+static std::size_t nextRecordStart(string_view text, std::size_t pos) {
+    if (pos > 0 && text[pos-1] != '\n') {
+        pos = text.find('\n', pos);
+        pos = (pos == string_view::npos) ? text.size() : pos + 1;
+    }
+    while (pos < text.size()) {
+        std::size_t end = text.find('\n', pos);
+        if (end == string_view::npos) end = text.size();
+        if (startsRecord(text.substr(pos, end - pos))) return pos;
+        pos = end + 1;
+    }
+    return text.size();
+}
+
+// Run task(i) for i from 0 to tasks-1 on the given number of threads
+template <typename F>
+static void runParallel(unsigned int threads, unsigned int tasks, F task) {
+    std::atomic<unsigned int> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned int t=0; t<threads; t++) {
+        workers.push_back(std::thread([&]() {
+            for (unsigned int i = next++; i < tasks; i = next++) task(i);
+        }));
+    }
+    for (std::thread& worker : workers) worker.join();
+}
+
+// Parse one chunk of the file into records, interning their symbols
+static void parseChunk(string_view text, unsigned int chunkNumber, ParsedChunk& chunk) {
+    string scratch[4];
+    unsigned long long ordinal = (unsigned long long)chunkNumber << 32;
+    chunk.records.reserve(text.size() / 32);
+    forEachRecord(text, [&](string_view record) {
+        ordinal++;
+        string_view start = record.substr(0, 5);
+        ParsedRecord parsed;
+        parsed.ordinal = ordinal;
+        parsed.room = RoomHandle::NONE;
+        if (start == "ROOM:" || start == "PATH:" || start == "ITEM:") {
+            string_view fields[3];
+            if (!splitFields(record, fields, scratch)) {
+                noteError(chunk, ordinal, "Error: Problem parsing data file");
+                return;
+            }
+            parsed.type = start[0];
+            parsed.symbol1 = Symbol(fields[0]);
+            if (start == "ROOM:") {
+                parsed.text1 = fields[1];
+                parsed.text2 = fields[2];
+            } else if (start == "PATH:") {
+                parsed.place = Symbol(fields[1]);
+                parsed.symbol2 = Symbol(fields[2]);
+            } else {
+                parsed.text1 = fields[1];
+                parsed.place = Symbol(fields[2]);
+            }
+        } else if (start == "INIT:") {
+            parsed.type = 'N';
+            parsed.symbol1 = Symbol(fieldText(record.substr(5), scratch[1]));
+        } else if (start == "WHEN:" || start == "THEN:") {
+            // triggers are few, and are processed later in file order
+            parsed.type = 'W';
+            parsed.text1 = record;
+        } else {
+            return;
+        }
+        chunk.records.push_back(std::move(parsed));
+    });
+}
+
+// Parse the text on several threads. Chunks of records are parsed in
+// parallel; the rooms are then added in file order, the rooms that
+// paths and items name are looked up in parallel, and the paths and
+// items are added in file order. A path or item may only name a room
+// defined before it, and the error thrown is the one the first bad
+// record in the file would give, just as with parseDungeon.
+void parseDungeonParallel(Dungeon& dungeon, string_view text, unsigned int threads) {
+    if (threads < 1) threads = 1;
+    std::vector<std::size_t> bounds(1, 0);
+    unsigned int pieces = threads * 4;
+    for (unsigned int i=1; i<pieces; i++) {
+        std::size_t pos = nextRecordStart(text, text.size() / pieces * i);
+        if (pos > bounds.back() && pos < text.size()) bounds.push_back(pos);
+    }
+    bounds.push_back(text.size());
+    unsigned int chunkCount = bounds.size() - 1;
+
+    std::vector<ParsedChunk> chunks(chunkCount);
+    runParallel(threads, chunkCount, [&](unsigned int c) {
+        parseChunk(text.substr(bounds[c], bounds[c+1] - bounds[c]), c, chunks[c]);
+    });
+
+    // rooms, in file order
+    ParsedChunk failures;
+    unsigned int roomCount = 0;
+    for (const ParsedChunk& chunk : chunks) {
+        for (const ParsedRecord& record : chunk.records) {
+            if (record.type == 'R') roomCount++;
+        }
+    }
+    dungeon.reserveRooms(dungeon.rooms.size() + roomCount);
+    std::vector<unsigned long long> roomOrdinals(dungeon.rooms.size(), 0);
+    for (ParsedChunk& chunk : chunks) {
+        for (ParsedRecord& record : chunk.records) {
+            if (record.type != 'R') continue;
+            if (dungeon.findRoom(record.symbol1).valid()) {
+                noteError(failures, record.ordinal, "Error: Duplicate room ID found in input file");
+                continue;
+            }
+            dungeon.addRoom(record.symbol1, std::move(record.text1), std::move(record.text2));
+            roomOrdinals.push_back(record.ordinal);
+        }
+    }
+
+    // the rooms paths and items are in
+    runParallel(threads, chunkCount, [&](unsigned int c) {
+        for (ParsedRecord& record : chunks[c].records) {
+            if (record.type != 'P' && record.type != 'I') continue;
+            RoomHandle room = dungeon.findRoom(record.place);
+            if (room.valid() && roomOrdinals[room.index] < record.ordinal) record.room = room.index;
+            else if (record.type == 'P') {
+                noteError(chunks[c], record.ordinal, "Error: Path from unknown room encountered in input file");
+            } else {
+                noteError(chunks[c], record.ordinal, "Error: Item placed in unknown room");
+            }
+        }
+    });
+
+    // paths, items, triggers and the starting room, in file order
+    string scratch[4];
+    for (ParsedChunk& chunk : chunks) {
+        for (ParsedRecord& record : chunk.records) {
+            if (record.type == 'N') dungeon.currentRoom = record.symbol1;
+            if (record.type == 'W') {
+                try {
+                    processTrigger(dungeon.triggers, record.text1, scratch);
+                } catch (string msg) {
+                    noteError(failures, record.ordinal, msg.c_str());
+                }
+            }
+            if (record.room == RoomHandle::NONE) continue;
+            if (record.type == 'P') {
+                if (!dungeon.rooms[record.room].addPath(record.symbol1, record.symbol2)) {
+                    noteError(failures, record.ordinal, "Error: Duplicate path source encountered in input file");
+                }
+            } else {
+                dungeon.addItem(dungeon.rooms[record.room].id, record.symbol1, std::move(record.text1));
+            }
+        }
+    }
+
+    for (const ParsedChunk& chunk : chunks) noteError(failures, chunk.errorAt, chunk.error.c_str());
+    if (failures.errorAt != ParsedChunk::NO_ERROR) throw failures.error;
+    checkTriggers(dungeon);
+}
+
+// Parse on as many threads as the machine has, if the text is big
+// enough for that to pay off
+static void parseText(Dungeon& dungeon, string_view text) {
+    unsigned int threads = std::thread::hardware_concurrency();
+    if (text.size() >= PARALLEL_MIN_BYTES && threads > 1) parseDungeonParallel(dungeon, text, threads);
+    else parseDungeon(dungeon, text);
+}
+
+void readFile(Dungeon& dungeon, const char* filename, std::size_t textBudget) {
+    MappedFile file(filename);
+    string image = DungeonImage::imageName(filename);
+    uint64_t checksum = DungeonImage::checksum(file.text());
+    DungeonImage::Status status = DungeonImage::load(dungeon, image.c_str(), checksum, textBudget);
+    if (status == DungeonImage::LOADED) return;
+    if (textBudget > 0) {
+        // paging needs an image to page from
+        {
+            Dungeon full;
+            parseText(full, file.text());
+            DungeonImage::write(full, image.c_str(), checksum);
+        }
+        if (DungeonImage::load(dungeon, image.c_str(), checksum, textBudget) != DungeonImage::LOADED) {
+            throw string("Error: Could not load dungeon image");
+        }
+        return;
+    }
+    parseText(dungeon, file.text());
+    // there is no usable image, so make one for the next run; it only
+    // saves time, so a failure to write it is not an error
+    try {
+        DungeonImage::write(dungeon, image.c_str(), checksum);
+    } catch (string msg) {
+    }
+}
+
+void compileFile(Dungeon& dungeon, const char* filename) {
+    MappedFile file(filename);
+    parseText(dungeon, file.text());
+    string image = DungeonImage::imageName(filename);
+    DungeonImage::write(dungeon, image.c_str(), DungeonImage::checksum(file.text()));
+}
@@ -0,0 +1,68 @@
+/*
+    DungeonLoader.h
+
+    This is the header file for the dungeon data file loader.
+
+    The data file is memory mapped and parsed in place: records and
+    fields are string_view slices of the mapping, and text is copied
+    only into the Dungeon itself. Lines may be of any length.
+
+    A data file may have a compiled image next to it (see
+    DungeonImage.h). readFile loads the image instead of parsing the
+    text when the image was made from the file's current text;
+    otherwise it parses the text and writes an image, the first time
+    or because the old one is out of date. Large files are parsed on
+    all of the machine's cores.
+*/
+
+#ifndef __DUNGEON_LOADER_H__
+#define __DUNGEON_LOADER_H__
+
+#include "Dungeon.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+using std::string;
+using std::string_view;
+
+// A read-only view of a whole file. Regular files are memory mapped;
+// anything that cannot be mapped (a pipe, for instance) is read into
+// memory instead.
+class MappedFile {
+public:
+    explicit MappedFile(const char* filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    string_view text() const { return string_view(data, length); }
+private:
+    const char* data;
+    std::size_t length;
+    bool mapped;
+    string buffer;      // file contents when the file is not mapped
+};
+
+// Reads a dungeon data file (or its compiled image) into dungeon
+// If textBudget is not 0, room text is paged in from the image (which
+// is built first if need be) keeping about textBudget bytes in memory.
+// This will throw an exception if it has any problems.
+void readFile(Dungeon& dungeon, const char* filename, std::size_t textBudget = 0);
+
+// Parses a dungeon data file into dungeon and writes its compiled image
+// This will throw an exception if it has any problems.
+void compileFile(Dungeon& dungeon, const char* filename);
+
+// Parses the text of a dungeon data file into dungeon
+// This will throw an exception if it has any problems.
+void parseDungeon(Dungeon& dungeon, string_view text);
+
+// Parses the WHEN and THEN records in text into triggers, skipping any
+// other records; the rooms the triggers name are not checked
+// This will throw an exception if it has any problems.
+void parseTriggers(TriggerTable& triggers, string_view text);
+
+// Parses the text of a dungeon data file into dungeon on several threads
+// Gives the same result, and throws the same exceptions, as parseDungeon.
+void parseDungeonParallel(Dungeon& dungeon, string_view text, unsigned int threads);
+
+#endif
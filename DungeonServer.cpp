@@ -0,0 +1,316 @@
+/*
+    DungeonServer.cpp
+
+    This is the implementation file for a DungeonServer object.
+*/
+
+#include "DungeonServer.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+using std::cerr;
+using std::endl;
+
+const std::size_t DungeonServer::MAX_INPUT;
+const std::size_t DungeonServer::OUTPUT_HIGH_WATER;
+
+namespace {
+
+// Set by SIGINT or SIGTERM to end run()
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+}
+
+DungeonServer::Connection::Connection(int fd, const Dungeon& dungeon)
+    : fd(fd), consumed(0), sent(0), started(false), ended(false), closing(false), reading(true),
+      session(dungeon) {}
+
+DungeonServer::DungeonServer(const Dungeon& dungeon) : dungeon(dungeon), epollFd(-1), spareFd(-1) {
+    // every session is a descriptor, so allow as many as the system will
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) throw string("Error: Could not create epoll instance");
+    spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+DungeonServer::~DungeonServer() {
+    for (auto& entry : connections) ::close(entry.first);
+    for (int fd : listeners) ::close(fd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+    if (spareFd >= 0) ::close(spareFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+void DungeonServer::listenTcp(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw string("Error: Could not create socket");
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof on);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof address) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        throw string("Error: Could not listen on port ") + std::to_string(port);
+    }
+    addListener(fd);
+}
+
+void DungeonServer::listenUnix(const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof address.sun_path) throw string("Error: Socket path is too long");
+    strcpy(address.sun_path, path);
+    // a socket left behind by an earlier server would make bind fail
+    struct stat info;
+    if (stat(path, &info) == 0 && S_ISSOCK(info.st_mode)) unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw string("Error: Could not create socket");
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof address) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        throw string("Error: Could not listen on ") + path;
+    }
+    unixPath = path;
+    addListener(fd);
+}
+
+void DungeonServer::addListener(int fd) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof event);
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        ::close(fd);
+        throw string("Error: Could not watch listening socket");
+    }
+    listeners.push_back(fd);
+}
+
+void DungeonServer::run() {
+    stopRequested = 0;
+    struct sigaction action;
+    memset(&action, 0, sizeof action);
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    static const int MAX_EVENTS = 256;
+    struct epoll_event events[MAX_EVENTS];
+    while (!stopRequested) {
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            throw string("Error: epoll_wait failed");
+        }
+        for (int e=0; e<count; e++) {
+            int fd = events[e].data.fd;
+            bool listener = false;
+            for (int l : listeners) {
+                if (l == fd) listener = true;
+            }
+            if (listener) {
+                acceptFrom(fd);
+                continue;
+            }
+            // an earlier event in this batch may have closed it
+            std::unordered_map<int, std::unique_ptr<Connection> >::iterator it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& c = *it->second;
+            if (events[e].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) readFrom(c);
+            else if (events[e].events & EPOLLOUT) {
+                if (writeTo(c)) serve(c);
+            }
+        }
+    }
+}
+
+// Accept every waiting connection and start its game
+void DungeonServer::acceptFrom(int listener) {
+    while (true) {
+        int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE && spareFd >= 0) {
+                // out of descriptors: accept and drop the connection with
+                // the spare one, so the listener does not stay readable
+                ::close(spareFd);
+                int refused = accept(listener, NULL, NULL);
+                if (refused >= 0) ::close(refused);
+                spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                continue;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);     // fails harmlessly on Unix sockets
+        struct epoll_event event;
+        memset(&event, 0, sizeof event);
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        Connection& c = *(connections[fd] = std::unique_ptr<Connection>(new Connection(fd, dungeon)));
+        serve(c);
+    }
+}
+
+// Read whatever the player has sent and carry out the complete lines
+void DungeonServer::readFrom(Connection& c) {
+    char buffer[4096];
+    // leave the rest in the socket while a full buffer is worked through
+    while (c.input.size() - c.consumed < MAX_INPUT) {
+        ssize_t n = recv(c.fd, buffer, sizeof buffer, 0);
+        if (n > 0) {
+            c.input.append(buffer, n);
+            continue;
+        }
+        if (n == 0) {
+            // the player has finished sending: carry out any last line, then close
+            if (!c.ended && c.consumed < c.input.size() && c.input.back() != '\n') c.input.push_back('\n');
+            c.ended = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            close(c);
+            return;
+        }
+        break;
+    }
+    serve(c);
+}
+
+// Play the game for a connection: start it, carry out waiting lines
+// while there is room for their output, and send what they produce.
+// Closes the connection when its game is over and the output is sent.
+void DungeonServer::serve(Connection& c) {
+    static StringOutput buffer;
+    static ostream out(&buffer);
+    buffer.target = &c.output;
+    // lines already read need no event to be carried out, so keep going
+    // for as long as the socket takes all of their output
+    while (true) {
+        try {
+            if (!c.started) {
+                c.started = true;
+                c.session.prompt(out);
+            }
+            while (!c.session.done && c.output.size() - c.sent < OUTPUT_HIGH_WATER) {
+                std::size_t end = c.input.find('\n', c.consumed);
+                if (end == string::npos) break;
+                string_view line(c.input.data() + c.consumed, end - c.consumed);
+                c.consumed = end + 1;
+                c.session.perform(line, out);
+                if (!c.session.done) c.session.prompt(out);
+            }
+        } catch (const string& msg) {
+            cerr << msg << endl;
+            out << msg << '\n';
+            c.session.done = true;
+        } catch (const std::exception& e) {
+            // out of memory, say: end this player's game, not the server
+            cerr << "Error: " << e.what() << endl;
+            c.session.done = true;
+            try {
+                out << "Error: " << e.what() << '\n';
+            } catch (const std::exception&) {
+            }
+        }
+        if (!c.closing && (c.session.done || (c.ended && !hasLine(c)))) {
+            out << "Thanks for playing. Visit again soon.\n";
+            c.closing = true;
+        }
+
+        // keep only the unfinished line
+        if (c.consumed > 0) {
+            c.input.erase(0, c.consumed);
+            c.consumed = 0;
+        }
+        if (c.input.size() >= MAX_INPUT && !hasLine(c)) {
+            close(c);
+            return;
+        }
+        if (!writeTo(c)) return;
+        if (c.closing && c.output.empty()) {
+            close(c);
+            return;
+        }
+        if (!c.output.empty() || c.session.done || !hasLine(c)) break;
+    }
+    watch(c);
+}
+
+// Whether a connection has a complete line waiting to be carried out
+bool DungeonServer::hasLine(const Connection& c) {
+    return c.input.find('\n', c.consumed) != string::npos;
+}
+
+// Send as much waiting output as the socket will take; returns false
+// if the connection was closed
+bool DungeonServer::writeTo(Connection& c) {
+    while (c.sent < c.output.size()) {
+        ssize_t n = send(c.fd, c.output.data() + c.sent, c.output.size() - c.sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.sent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            close(c);
+            return false;
+        }
+    }
+    if (c.sent == c.output.size()) {
+        c.output.clear();
+        c.sent = 0;
+    }
+    return true;
+}
+
+// Wait for input when all output is sent and every complete line has
+// been carried out, and for room to send otherwise
+void DungeonServer::watch(Connection& c) {
+    bool reading = c.output.empty() && !hasLine(c);
+    if (reading == c.reading) return;
+    struct epoll_event event;
+    memset(&event, 0, sizeof event);
+    event.events = reading ? (EPOLLIN | EPOLLRDHUP) : EPOLLOUT;
+    event.data.fd = c.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &event);
+    c.reading = reading;
+}
+
+void DungeonServer::close(Connection& c) {
+    int fd = c.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+    ::close(fd);
+    connections.erase(fd);
+}
@@ -0,0 +1,81 @@
+/*
+    DungeonServer.h
+
+    This is the header file for a DungeonServer object. A DungeonServer
+    lets many players play one loaded Dungeon at once over TCP or
+    Unix-domain sockets. Each connection is a GameSession that sees the
+    same prompts and output as the interactive game.
+
+    The server is a single thread running a non-blocking epoll loop.
+    Every connection has its own input and output buffers: complete
+    lines are taken from the input buffer and carried out in order, and
+    a connection whose output is backing up is not read from until the
+    player catches up. TCP listeners set SO_REUSEPORT, so one server
+    process per core can share a port.
+*/
+
+#ifndef __DUNGEON_SERVER_H__
+#define __DUNGEON_SERVER_H__
+
+#include "Dungeon.h"
+#include "GameSession.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using std::string;
+
+class DungeonServer {
+public:
+    explicit DungeonServer(const Dungeon& dungeon);
+    ~DungeonServer();
+    DungeonServer(const DungeonServer&) = delete;
+    DungeonServer& operator=(const DungeonServer&) = delete;
+
+    // Accept players on a TCP port on every interface
+    // This will throw an exception if the port cannot be used.
+    void listenTcp(unsigned short port);
+    // Accept players on a Unix-domain socket, replacing any stale one
+    // This will throw an exception if the socket cannot be made.
+    void listenUnix(const char* path);
+    // Serve players until the process is sent SIGINT or SIGTERM
+    void run();
+    unsigned int sessionCount() const { return connections.size(); }
+
+    // a line may be at most this long; a longer one closes the connection
+    static const std::size_t MAX_INPUT = 64 * 1024;
+    // commands are not read while this much output is waiting to be sent
+    static const std::size_t OUTPUT_HIGH_WATER = 64 * 1024;
+private:
+    struct Connection {
+        int fd;
+        string input;
+        std::size_t consumed;       // bytes of input already carried out
+        string output;
+        std::size_t sent;           // bytes of output already sent
+        bool started;               // the first prompt has been given
+        bool ended;                 // the player has sent all they will send
+        bool closing;               // the game is over: close once the output is sent
+        bool reading;               // registered for input rather than output
+        GameSession session;
+        Connection(int fd, const Dungeon& dungeon);
+    };
+    const Dungeon& dungeon;
+    int epollFd;
+    int spareFd;                    // given up to accept (and refuse) when out of descriptors
+    std::vector<int> listeners;
+    string unixPath;
+    std::unordered_map<int, std::unique_ptr<Connection> > connections;
+
+    void addListener(int fd);
+    void acceptFrom(int listener);
+    void readFrom(Connection& c);
+    void serve(Connection& c);
+    bool writeTo(Connection& c);
+    void watch(Connection& c);
+    static bool hasLine(const Connection& c);
+    void close(Connection& c);
+};
+
+#endif
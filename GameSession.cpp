@@ -0,0 +1,193 @@
+/*
+    GameSession.cpp
+
+    This is the implementation file for a GameSession object.
+*/
+
+#include "GameSession.h"
+#include <cstring>
+#include <strings.h>
+
+GameSession::GameSession(const Dungeon& dungeon)
+    : currentRoom(dungeon.currentRoom), done(false), prompts(true), world(dungeon), dungeon(dungeon),
+      renderer(dungeon) {}
+
+void GameSession::prompt(ostream& out) {
+    out << '\n';
+    RoomHandle here = dungeon.findRoom(currentRoom);
+    if (!here.valid()) throw string("Error: Current room is unknown.\n");
+    describeRoom(here.index, out);
+    if (strcasecmp(currentRoom.str().c_str(), "outside") == 0) {
+        out << "Congratulations! You have won the game.\n";
+        done = true;
+        return;
+    }
+    if (prompts) out << "Enter command: ";
+}
+
+void GameSession::perform(string_view line, ostream& out) {
+    RoomHandle here = dungeon.findRoom(currentRoom);
+    if (!here.valid()) throw string("Error: Current room is unknown.\n");
+    unsigned int room = here.index;
+    Command command = parser.parse(line);
+
+    if (command.verb == TRAVEL) {
+        // room ids may contain spaces and capitals, so use the rest of the line as typed
+        string_view target = command.rest;
+        RoomHandle to = dungeon.findRoom(Symbol::lookup(target));
+        if (target.empty()) out << "You must specify a room to travel to\n";
+        else if (!to.valid()) out << "There is no room called " << target << ".\n";
+        else if (!world.findRoute(room, to.index, route)) {
+            out << "You can't get there from here.\n";
+        } else if (route.empty()) out << "You are already there.\n";
+        else {
+            out << "You travel:";
+            for (Symbol direction : route) out << ' ' << direction;
+            out << '\n';
+            currentRoom = dungeon.rooms[to.index].id;
+        }
+    } else if (command.words == 0 || command.words > 2) out << "Command not understood\n";
+    else { // command is one or two words long
+        string_view object = command.object;
+        switch (command.verb) {
+        case DROP:
+            if (object == "") out << "You must specify an object to drop\n";
+            else {
+                // the most recently taken item of that name goes first
+                moved.clear();
+                if (object == "all") {
+                    world.forEachItem(WorldOverlay::INVENTORY, [this](const Item& item) {
+                        moved.push_back(item.name);
+                    });
+                    world.moveAllItems(WorldOverlay::INVENTORY, room);
+                } else if (world.moveItem(Symbol::lookup(object), WorldOverlay::INVENTORY, room)) {
+                    moved.push_back(Symbol::lookup(object));
+                }
+                for (Symbol item : moved) fire(ON_DROP, room, item, out);
+            }
+            break;
+        case TAKE:
+            if (object == "") out << "You must specify an object to take\n";
+            else {
+                moved.clear();
+                if (object == "all") {
+                    world.forEachItem(room, [this](const Item& item) {
+                        moved.push_back(item.name);
+                    });
+                    world.moveAllItems(room, WorldOverlay::INVENTORY);
+                } else if (world.moveItem(Symbol::lookup(object), room, WorldOverlay::INVENTORY)) {
+                    moved.push_back(Symbol::lookup(object));
+                }
+                for (Symbol item : moved) fire(ON_TAKE, room, item, out);
+            }
+            break;
+        case INVENTORY: {
+            out << "You are carrying: ";
+            if (world.itemCount(WorldOverlay::INVENTORY) == 0) out << "nothing";
+            else {
+                const char* separator = "";
+                world.forEachItem(WorldOverlay::INVENTORY, [&separator, &out](const Item& item) {
+                    out << separator << item.name;
+                    separator = ", ";
+                });
+            }
+            out << '\n';
+            break;
+        }
+        case QUIT:
+            done = true;
+            break;
+        case EXIT:
+            out << "Use 'quit' to end the game.\n";
+            break;
+        case HELP:
+            out << "Commands are: help, quit, look, drop, take, go, travel, inv, and the exit directions\n";
+            break;
+        case LOOK:
+            world.setVisited(room, false);
+            break;
+        case XYZZY:
+            if (!fire(ON_XYZZY, room, Symbol(), out)) out << "Does this look like a colossal cave?\n";
+            break;
+        default: {
+            // a standard direction is a table load; any other word may
+            // name one of the room's custom exits
+            const Path* path = (command.direction != NUM_DIRECTIONS)
+                ? world.getExit(room, command.direction)
+                : world.getPath(room, Symbol::lookup(command.word));
+            if (path == NULL) {
+                out << "Unknown command. Try again.\n";
+            } else if (!dungeon.findRoom(path->to).valid()) {
+                out << "Path doesn't lead to a known room.\n";
+            } else {
+                currentRoom = path->to;
+            }
+            break;
+        }
+        }
+    }
+}
+
+// Carries out the actions of the first trigger for an event whose
+// conditions hold; returns false if there is none
+bool GameSession::fire(TriggerEvent event, unsigned int room, Symbol item, ostream& out) {
+    return dungeon.triggers.forEachCandidate(event, dungeon.rooms[room].id, item, [&](const Trigger& trigger) {
+        for (const TriggerCondition& condition : trigger.conditions) {
+            unsigned int owner = (condition.kind == TriggerCondition::HERE) ? room : WorldOverlay::INVENTORY;
+            if (world.findItem(owner, condition.item) == NULL) return false;
+        }
+        for (const TriggerAction& action : trigger.actions) act(action, room, out);
+        return true;
+    });
+}
+
+// Carries out one action of a trigger for an event in room
+void GameSession::act(const TriggerAction& action, unsigned int room, ostream& out) {
+    RoomHandle target = action.room.empty() ? RoomHandle() : dungeon.findRoom(action.room);
+    switch (action.kind) {
+    case TriggerAction::SAY:
+        out << action.text << '\n';
+        break;
+    case TriggerAction::REMOVE:
+        if (!world.removeItem(action.item, room)) world.removeItem(action.item, WorldOverlay::INVENTORY);
+        break;
+    case TriggerAction::PATH:
+        if (target.valid()) world.addPath(target.index, action.direction, action.to);
+        break;
+    case TriggerAction::REPLACE:
+        if (target.valid()) {
+            string description = world.roomDescription(target.index);
+            std::size_t found = description.rfind(action.text);
+            if (found != string::npos) {
+                description.replace(found, action.text.length(), action.replacement);
+                world.setRoomDescription(target.index, description);
+            }
+            // show the player the room's new state next time they are there
+            world.setVisited(target.index, false);
+        }
+        break;
+    case TriggerAction::DESCRIBE:
+        if (target.valid()) {
+            world.setRoomDescription(target.index, action.text);
+            world.setVisited(target.index, false);
+        }
+        break;
+    case TriggerAction::TELEPORT:
+        if (target.valid()) currentRoom = dungeon.rooms[target.index].id;
+        break;
+    }
+}
+
+void GameSession::writeState(ostream& out) const {
+    out << "room " << currentRoom << '\n';
+    out << (done ? "done\n" : "playing\n");
+    world.writeState(out);
+}
+
+// prints room description
+// diplays short description if room is marked as
+// visited and long description otherwise
+void GameSession::describeRoom(unsigned int index, ostream& out) {
+    renderer.render(world, index, !world.visited(index), out);
+    world.setVisited(index, true);
+}
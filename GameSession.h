@@ -0,0 +1,57 @@
+/*
+    GameSession.h
+
+    This is the header file for a GameSession object. A GameSession is
+    one player's game: where the player is, which rooms they have seen,
+    and the commands they type. The interactive game and the server
+    both play through a GameSession, so commands mean the same thing
+    in each.
+
+    The Dungeon is never changed by play. Everything a player's game
+    changes (items taken and dropped, exits opened, descriptions
+    rewritten, rooms seen) goes into the session's WorldOverlay, so any
+    number of sessions can share one loaded Dungeon.
+*/
+
+#ifndef __GAME_SESSION_H__
+#define __GAME_SESSION_H__
+
+#include "Command.h"
+#include "Dungeon.h"
+#include "RoomRenderer.h"
+#include "WorldOverlay.h"
+#include <iostream>
+#include <string_view>
+#include <vector>
+using std::ostream;
+using std::string_view;
+
+class GameSession {
+public:
+    Symbol currentRoom;
+    bool done;                      // the player has quit or won
+    bool prompts;                   // ask "Enter command: " before each command
+    WorldOverlay world;             // this player's changes to the dungeon
+
+    // Starts a game in the dungeon's starting room
+    explicit GameSession(const Dungeon& dungeon);
+    // Describes the player's room and asks for a command, or ends the
+    // game if the player has won
+    // This will throw an exception if the player is in an unknown room.
+    void prompt(ostream& out);
+    // Carries out one line typed by the player
+    void perform(string_view line, ostream& out);
+    // Writes where the player is and everything their game has changed
+    void writeState(ostream& out) const;
+private:
+    const Dungeon& dungeon;
+    CommandParser parser;
+    std::vector<Symbol> route;
+    std::vector<Symbol> moved;      // items taken or dropped by the command
+    RoomRenderer renderer;
+    void describeRoom(unsigned int index, ostream& out);
+    bool fire(TriggerEvent event, unsigned int room, Symbol item, ostream& out);
+    void act(const TriggerAction& action, unsigned int room, ostream& out);
+};
+
+#endif
@@ -0,0 +1,273 @@
+/*
+    GenerateDungeon.cpp
+
+    Writes a random dungeon data file, in the same record format as
+    dungeon.txt, for testing the game at sizes the real data
+    file never reaches.
+
+    Build and run:
+        g++ -std=c++17 -O2 -o GenerateDungeon GenerateDungeon.cpp
+        ./GenerateDungeon [-r rooms] [-b exits] [-i items] [-l length] [-t triggers] [-s seed] [outfileName]
+
+        -r rooms    number of rooms, counting outside (default 1000)
+        -b exits    average number of exits per room, 2 to 8 (default 3)
+        -i items    average number of items per room (default 0.1)
+        -l length   approximate length of a room description (default 80)
+        -t triggers number of scripted events (default 0)
+        -s seed     random seed (default 1)
+
+    The file is written to standard output if no name is given.
+
+    The rooms are laid out on a square grid and exits only lead to one
+    of the eight neighbouring squares, so the compass directions make
+    sense. Every room is first joined to a random earlier neighbour in
+    both directions, which makes all of them reachable from each other;
+    extra exits are then added up to the requested average. A room
+    picked at random from the bottom row has an exit south to
+    "outside". The game starts in the top left room. Each trigger
+    fires when an item of some kind is dropped in a room, opening a
+    hidden passage down to another room.
+
+    The same options always give the same file, on any machine: the
+    generator uses its own random number generator rather than the
+    standard library's distributions.
+*/
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+
+// SplitMix64: small, fast and identical on every platform
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // A number from 0 to n-1
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+private:
+    uint64_t state;
+};
+
+// The eight compass directions, as steps on the grid
+static const int NUM_STEPS = 8;
+static const char* STEP_NAMES[NUM_STEPS] = { "n", "ne", "e", "se", "s", "sw", "w", "nw" };
+static const int STEP_X[NUM_STEPS] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int STEP_Y[NUM_STEPS] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+// The direction back the way a step came
+static int reverse(int step) {
+    return (step + NUM_STEPS / 2) % NUM_STEPS;
+}
+
+static const char* KINDS[] = {
+    "office", "classroom", "lab", "storeroom", "hallway", "closet",
+    "lounge", "workshop", "server room", "library"
+};
+static const char* ADJECTIVES[] = {
+    "dusty", "cramped", "bright", "dim", "cluttered", "empty", "quiet",
+    "narrow", "musty", "carpeted", "cold", "humid", "abandoned", "tidy"
+};
+static const char* NOUNS[] = {
+    "desk", "chair", "computer", "cable", "shelf", "window", "poster",
+    "whiteboard", "cabinet", "printer", "lamp", "box", "binder", "plant"
+};
+static const char* ITEMS[] = {
+    "stapler", "keyboard", "mouse", "textbook", "mug", "flashlight",
+    "badge", "umbrella", "notebook", "calculator", "router", "screwdriver"
+};
+
+template <typename T, std::size_t N>
+static uint32_t count(T (&)[N]) {
+    return N;
+}
+
+// "a" or "an", whichever goes before word
+static const char* article(const char* word) {
+    return strchr("aeiou", word[0]) ? "an" : "a";
+}
+
+// A sentence of about length characters, with no ':' in it
+static void describe(Random& random, unsigned int length, string& out) {
+    const char* adjective = ADJECTIVES[random.below(count(ADJECTIVES))];
+    out = article(adjective);
+    out[0] = 'A';
+    out += ' ';
+    out += adjective;
+    out += " room";
+    while (out.size() + 1 < length) {
+        adjective = ADJECTIVES[random.below(count(ADJECTIVES))];
+        out += random.below(2) ? " with " : " and ";
+        out += article(adjective);
+        out += ' ';
+        out += adjective;
+        out += ' ';
+        out += NOUNS[random.below(count(NOUNS))];
+    }
+    out += '.';
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long rooms = 1000;
+    double exits = 3.0;
+    double items = 0.1;
+    unsigned long length = 80;
+    unsigned long triggers = 0;
+    uint64_t seed = 1;
+    const char* fileName = NULL;
+    bool error = false;
+
+    for (int i=1; i<argc; i++) {
+        bool hasValue = (i+1 < argc);
+        if (strcmp(argv[i], "-r") == 0 && hasValue) {
+            rooms = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-b") == 0 && hasValue) {
+            exits = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-i") == 0 && hasValue) {
+            items = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-l") == 0 && hasValue) {
+            length = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && hasValue) {
+            triggers = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0 && hasValue) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if ((strlen(argv[i]) > 0) && (argv[i][0] == '-')) {
+            cerr << "Unrecognized option: " << argv[i] << endl;
+            error = true;
+        } else if (fileName != NULL) {
+            error = true;
+        } else {
+            fileName = argv[i];
+        }
+    }
+    if (rooms < 2 || rooms > 0xFFFFFFFEul || exits < 2 || exits > NUM_STEPS || items < 0) {
+        cerr << "Error: need at least 2 rooms and between 2 and 8 exits per room" << endl;
+        error = true;
+    }
+    if (error) {
+        cerr << "Usage: " << argv[0] << " [-r rooms] [-b exits] [-i items] [-l length] [-t triggers] [-s seed] [outfileName]\n";
+        return 1;
+    }
+
+    // the last room is outside; the others fill a square grid row by row
+    uint32_t grid = rooms - 1;
+    uint32_t width = 1;
+    while ((uint64_t)width * width < grid) width++;
+    uint32_t height = (grid + width - 1) / width;
+    Random random(seed);
+
+    // the room a step leads to from room r, or grid if it is off the grid
+    auto neighbour = [&](uint32_t r, int step) -> uint32_t {
+        int64_t x = (int64_t)(r % width) + STEP_X[step];
+        int64_t y = (int64_t)(r / width) + STEP_Y[step];
+        if (x < 0 || y < 0 || x >= width) return grid;
+        uint64_t n = (uint64_t)y * width + x;
+        return (n < grid) ? (uint32_t)n : grid;
+    };
+
+    // one bit per direction for each room's exits
+    vector<uint8_t> exitBits(grid, 0);
+    uint64_t exitCount = 0;
+    auto join = [&](uint32_t r, int step) {
+        uint32_t n = neighbour(r, step);
+        if (!(exitBits[r] & (1 << step))) exitCount++;
+        if (!(exitBits[n] & (1 << reverse(step)))) exitCount++;
+        exitBits[r] |= 1 << step;
+        exitBits[n] |= 1 << reverse(step);
+    };
+
+    // a random tree: each room is joined to an earlier neighbour
+    // (w, nw, n or ne), so every room can reach the first
+    static const int BACK_STEPS[4] = { 6, 7, 0, 1 };
+    for (uint32_t r=1; r<grid; r++) {
+        int choices[4];
+        int found = 0;
+        for (int step : BACK_STEPS) {
+            if (neighbour(r, step) < grid) choices[found++] = step;
+        }
+        join(r, choices[random.below(found)]);
+    }
+
+    // extra exits, up to the requested average; a full grid may not
+    // have room for them all, so give up after a while
+    uint64_t wanted = (uint64_t)(exits * grid);
+    uint64_t tries = 0;
+    while (exitCount + 1 < wanted && tries < 8 * wanted) {
+        tries++;
+        uint32_t r = random.below(grid);
+        int step = random.below(NUM_STEPS);
+        if (neighbour(r, step) < grid) join(r, step);
+    }
+
+    // the way out, from a random room on the bottom row, the row
+    // farthest from the start
+    uint32_t lastRow = (height - 1) * width;
+    uint32_t exitRoom = lastRow + random.below(grid - lastRow);
+
+    FILE* out = (fileName == NULL) ? stdout : fopen(fileName, "w");
+    if (out == NULL) {
+        cerr << "Error: Could not open " << fileName << endl;
+        return 1;
+    }
+    static char buffer[1 << 16];
+    setvbuf(out, buffer, _IOFBF, sizeof buffer);
+
+    string description;
+    for (uint32_t r=0; r<grid; r++) {
+        describe(random, length, description);
+        const char* kind = KINDS[random.below(count(KINDS))];
+        fprintf(out, "ROOM:R-%u:%s R-%u:%s\n", r, kind, r, description.c_str());
+    }
+    fprintf(out, "ROOM:outside:the bright sun outside:The day is beautiful, warm, and dry. You have escaped the dungeon.\n");
+
+    for (uint32_t r=0; r<grid; r++) {
+        for (int step=0; step<NUM_STEPS; step++) {
+            if (exitBits[r] & (1 << step)) {
+                fprintf(out, "PATH:%s:R-%u:R-%u\n", STEP_NAMES[step], r, neighbour(r, step));
+            }
+        }
+    }
+    fprintf(out, "PATH:s:R-%u:outside\n", exitRoom);
+
+    // whole items per room, plus one more with the fractional chance
+    uint32_t whole = (uint32_t)items;
+    uint32_t chance = (uint32_t)((items - whole) * 1000000);
+    for (uint32_t r=0; r<grid; r++) {
+        uint32_t n = whole + (random.below(1000000) < chance ? 1 : 0);
+        for (uint32_t i=0; i<n; i++) {
+            const char* adjective = ADJECTIVES[random.below(count(ADJECTIVES))];
+            const char* item = ITEMS[random.below(count(ITEMS))];
+            fprintf(out, "ITEM:%s:%s %s %s lies here.:R-%u\n", item, (strchr("aeiou", adjective[0]) ? "An" : "A"),
+                    adjective, item, r);
+        }
+    }
+    fprintf(out, "INIT:R-0\n");
+
+    // triggers come last, so that adding them does not change the rest
+    for (unsigned long t=0; t<triggers; t++) {
+        uint32_t r = random.below(grid);
+        const char* item = ITEMS[random.below(count(ITEMS))];
+        fprintf(out, "WHEN:drop:R-%u:%s\n", r, item);
+        fprintf(out, "THEN:say:The %s sinks into the floor, and a hidden passage opens.\n", item);
+        fprintf(out, "THEN:path:d:R-%u:R-%u\n", r, random.below(grid));
+    }
+
+    if (ferror(out) || (out != stdout && fclose(out) != 0)) {
+        cerr << "Error: Problem writing the dungeon" << endl;
+        return 1;
+    }
+    return 0;
+}
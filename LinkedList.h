@@ -10,7 +10,13 @@
 #define __LINKED_LIST_H__
 
 #include <cassert>
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "PoolAllocator.h"
 #include <stdexcept>
 #include <sstream>
 using std::out_of_range;
@@ -23,49 +29,125 @@ using std::stringstream;
 using std::vector;
 #endif
 
-template <typename T>
+template <typename T, typename Alloc = PoolAllocator<T> >
 class LinkedList {
 private:
     class Node {
     public:
-        Node() : next(NULL), prev(NULL) {}
-        Node(T sentData) : data(sentData), next(NULL), prev(NULL) {}
-        T data;
+        template <typename... Args>
+        Node(Args&&... args) : next(NULL), prev(NULL), data(std::forward<Args>(args)...) {}
+        // next must stay the first member: PoolAllocator threads its
+        // free list through the first word, so a chain of nodes can be
+        // handed back to the pool without relinking it.
         Node *next;
         Node *prev;
+        T data;
     };
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
     Node *head;
     Node *tail;
     unsigned int count;
+    NodeAlloc alloc;
+    template <typename... Args>
+    Node* makeNode(Args&&... args);
+    void freeNode(Node *p);
+    void linkFront(Node *newNode);
+    void linkBack(Node *newNode);
+    void linkAt(unsigned int pos, Node *newNode);
+    void linkBefore(Node *pNext, Node *newNode);
+    void unlinkRange(Node *first, Node *last);
+    void linkRangeBefore(Node *pNext, Node *first, Node *last);
+    template <typename A>
+    auto freeNodes(A& a, Node *first, Node *last, int) -> decltype(a.deallocate_chain(first, last));
+    template <typename A>
+    void freeNodes(A& a, Node *first, Node *last, long);
 public:
+    // Bidirectional iterator over the list. V is either T or const T.
+    // The end() iterator remembers its list so that it can be
+    // decremented back onto the tail.
+    template <typename V>
+    class Iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef V* pointer;
+        typedef V& reference;
+        Iterator() : node(NULL), list(NULL) {}
+        Iterator(const Iterator<T>& it) : node(it.node), list(it.list) {}
+        Iterator& operator=(const Iterator& it) { node = it.node; list = it.list; return *this; }
+        V& operator*() const { return node->data; }
+        V* operator->() const { return &node->data; }
+        Iterator& operator++() { node = node->next; return *this; }
+        Iterator operator++(int) { Iterator it(*this); node = node->next; return it; }
+        Iterator& operator--() { node = (node == NULL) ? list->tail : node->prev; return *this; }
+        Iterator operator--(int) { Iterator it(*this); --(*this); return it; }
+        bool operator==(const Iterator& it) const { return node == it.node; }
+        bool operator!=(const Iterator& it) const { return node != it.node; }
+    private:
+        Iterator(Node *n, const LinkedList *l) : node(n), list(l) {}
+        Node *node;
+        const LinkedList *list;
+        friend class LinkedList;
+    };
+    typedef Iterator<T> iterator;
+    typedef Iterator<const T> const_iterator;
+
     LinkedList();
     LinkedList(const LinkedList& lst);
+    LinkedList(LinkedList&& lst) noexcept;
     ~LinkedList();
+    LinkedList<T, Alloc>& operator=(const LinkedList& lst);
+    LinkedList<T, Alloc>& operator=(LinkedList&& lst) noexcept;
     void clear();
     unsigned int size() const;
     bool empty() const;
-    LinkedList<T>& push_front(T data);
-    LinkedList<T>& push_back(T data);
-    LinkedList<T>& push(T data);
+    LinkedList<T, Alloc>& push_front(const T& data);
+    LinkedList<T, Alloc>& push_front(T&& data);
+    LinkedList<T, Alloc>& push_back(const T& data);
+    LinkedList<T, Alloc>& push_back(T&& data);
+    LinkedList<T, Alloc>& push(const T& data);
+    LinkedList<T, Alloc>& push(T&& data);
+    template <typename... Args>
+    T& emplace_front(Args&&... args);
+    template <typename... Args>
+    T& emplace_back(Args&&... args);
     T pop_front();
     T pop_back();
     T pop();
-    T peek_front();
-    T peek_back();
-    T peek();
+    T& peek_front();
+    T& peek_back();
+    T& peek();
+    const T& peek_front() const;
+    const T& peek_back() const;
+    const T& peek() const;
 
-    void insertAt(unsigned int pos, T data);
+    void insertAt(unsigned int pos, const T& data);
+    void insertAt(unsigned int pos, T&& data);
     void deleteAt(unsigned int pos);
-    bool remove(T data);
-    bool contains(T data);
+    bool remove(const T& data);
+    bool contains(const T& data) const;
     T& operator[](const unsigned int pos);
 
+    iterator begin() { return iterator(head, this); }
+    iterator end() { return iterator(NULL, this); }
+    const_iterator begin() const { return const_iterator(head, this); }
+    const_iterator end() const { return const_iterator(NULL, this); }
+    iterator insert(const_iterator pos, const T& data);
+    iterator insert(const_iterator pos, T&& data);
+    iterator erase(const_iterator pos);
+    void splice(const_iterator pos, LinkedList& other);
+    void splice(const_iterator pos, LinkedList& other, const_iterator it);
+    void splice(const_iterator pos, LinkedList& other, const_iterator first, const_iterator last);
+    template <typename Pred>
+    unsigned int remove_if(Pred pred);
+
 #ifdef DEBUG
     static bool test();
     static bool check(const vector<int>& v, const LinkedList<int>& lst);
 #endif
 
-    friend ostream& operator<<(ostream& strm, const LinkedList<T>& lst) {
+    friend ostream& operator<<(ostream& strm, const LinkedList<T, Alloc>& lst) {
         Node *p = lst.head;
         strm << "[";
         while (p != NULL) {
@@ -79,22 +161,22 @@ public:
 };
 
 // Default constructor
-template <typename T>
-LinkedList<T>::LinkedList() : head(NULL), tail(NULL), count(0) { }
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>::LinkedList() : head(NULL), tail(NULL), count(0) { }
 
 // Copy constructor
-template <typename T>
-LinkedList<T>::LinkedList(const LinkedList& lst) {
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>::LinkedList(const LinkedList& lst) : alloc(lst.alloc) {
     if (lst.head == NULL) {
         head = tail = NULL;
         count = 0;
     } else {
-        head = new Node(lst.head->data);
+        head = makeNode(lst.head->data);
 
         Node *ptrCurr = head;
         Node *ptrOld = lst.head->next;
         while (ptrOld != NULL) {
-            ptrCurr->next = new Node(ptrOld->data);
+            ptrCurr->next = makeNode(ptrOld->data);
             // *** Need to set the next node's prev ptr to current node
             ptrCurr->next->prev = ptrCurr;
             ptrCurr = ptrCurr->next;
@@ -106,41 +188,118 @@ LinkedList<T>::LinkedList(const LinkedList& lst) {
     }
 }
 
+// Move constructor
+// The nodes are taken over from lst, which is left empty.
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>::LinkedList(LinkedList&& lst) noexcept
+    : head(lst.head), tail(lst.tail), count(lst.count), alloc(std::move(lst.alloc)) {
+    lst.head = lst.tail = NULL;
+    lst.count = 0;
+}
+
 // Destructor
-template <typename T>
-LinkedList<T>::~LinkedList() {
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>::~LinkedList() {
     clear();
 }
 
+// Assignment operator
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::operator=(const LinkedList& lst) {
+    if (this != &lst) {
+        clear();
+        for (Node *p = lst.head; p != NULL; p = p->next) push_back(p->data);
+    }
+    return *this;
+}
+
+// Move assignment operator
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::operator=(LinkedList&& lst) noexcept {
+    if (this != &lst) {
+        clear();
+        head = lst.head;
+        tail = lst.tail;
+        count = lst.count;
+        alloc = std::move(lst.alloc);
+        lst.head = lst.tail = NULL;
+        lst.count = 0;
+    }
+    return *this;
+}
+
 // Remove all items from list
-template <typename T>
-void LinkedList<T>::clear() {
-    Node *p = head;
-    while (head != NULL) {
-        p = head;
-        head = head->next;
-        delete p;
+// The nodes go back to the allocator as one chain; with the default
+// PoolAllocator that is a constant time operation once the items
+// themselves have been destroyed.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::clear() {
+    if (head == NULL) return;
+    if (!std::is_trivially_destructible<T>::value) {
+        for (Node *p = head; p != NULL; p = p->next) p->data.~T();
     }
-    tail = NULL;
+    freeNodes(alloc, head, tail, 0);
+    head = tail = NULL;
     count = 0;
 }
 
+// Allocate and construct a node from the list's allocator
+template <typename T, typename Alloc>
+template <typename... Args>
+typename LinkedList<T, Alloc>::Node* LinkedList<T, Alloc>::makeNode(Args&&... args) {
+    Node *p = std::allocator_traits<NodeAlloc>::allocate(alloc, 1);
+    try {
+        new (p) Node(std::forward<Args>(args)...);
+    } catch (...) {
+        std::allocator_traits<NodeAlloc>::deallocate(alloc, p, 1);
+        throw;
+    }
+    return p;
+}
+
+// Destroy a node and return it to the list's allocator
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::freeNode(Node *p) {
+    p->~Node();
+    std::allocator_traits<NodeAlloc>::deallocate(alloc, p, 1);
+}
+
+// Return an already destroyed chain of nodes, first to last, to an
+// allocator that can take it back in one step
+template <typename T, typename Alloc>
+template <typename A>
+auto LinkedList<T, Alloc>::freeNodes(A& a, Node *first, Node *last, int) -> decltype(a.deallocate_chain(first, last)) {
+    return a.deallocate_chain(first, last);
+}
+
+// Return an already destroyed chain of nodes one at a time, for
+// allocators without chain support
+template <typename T, typename Alloc>
+template <typename A>
+void LinkedList<T, Alloc>::freeNodes(A& a, Node *first, Node *last, long) {
+    Node *p = first;
+    while (p != NULL) {
+        Node *next = (p == last) ? NULL : p->next;
+        std::allocator_traits<NodeAlloc>::deallocate(a, p, 1);
+        p = next;
+    }
+}
+
 // Return number of items in list
-template <typename T>
-unsigned int LinkedList<T>::size() const {
+template <typename T, typename Alloc>
+unsigned int LinkedList<T, Alloc>::size() const {
     return count;
 }
 
 // Return true if list has no items
-template <typename T>
-bool LinkedList<T>::empty() const {
+template <typename T, typename Alloc>
+bool LinkedList<T, Alloc>::empty() const {
     return count == 0;
 }
 
-// Add an item to the front of the list
-template <typename T>
-LinkedList<T>& LinkedList<T>::push_front(T data) {
-    Node *newNode = new Node(data);
+// Link a new node in at the front of the list
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::linkFront(Node *newNode) {
     // *** Need to set the new node's prev ptr to NULL
     newNode->prev = NULL;
     if (head != NULL) head->prev = newNode;// *** then set the old head's prev ptr to the new node
@@ -148,13 +307,11 @@ LinkedList<T>& LinkedList<T>::push_front(T data) {
     newNode->next = head;
     head = newNode;
     count++;
-    return *this;
 }
 
-// Add an item to the back of the list
-template <typename T>
-LinkedList<T>& LinkedList<T>::push_back(T data) {
-    Node *newNode = new Node(data);
+// Link a new node in at the back of the list
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::linkBack(Node *newNode) {
     newNode->next = NULL;
     if (tail != NULL) tail->next = newNode;
     else head = newNode;
@@ -162,90 +319,149 @@ LinkedList<T>& LinkedList<T>::push_back(T data) {
     newNode->prev = tail;
     tail = newNode;
     count++;
+}
+
+// Add an item to the front of the list
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::push_front(const T& data) {
+    linkFront(makeNode(data));
+    return *this;
+}
+
+// Move an item to the front of the list
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::push_front(T&& data) {
+    linkFront(makeNode(std::move(data)));
+    return *this;
+}
+
+// Add an item to the back of the list
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::push_back(const T& data) {
+    linkBack(makeNode(data));
+    return *this;
+}
+
+// Move an item to the back of the list
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::push_back(T&& data) {
+    linkBack(makeNode(std::move(data)));
     return *this;
 }
 
 // Add an item to the list (alias for push_back)
-template <typename T>
-LinkedList<T>& LinkedList<T>::push(T data) {
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::push(const T& data) {
     return push_back(data);
 }
 
+// Move an item to the list (alias for push_back)
+template <typename T, typename Alloc>
+LinkedList<T, Alloc>& LinkedList<T, Alloc>::push(T&& data) {
+    return push_back(std::move(data));
+}
+
+// Construct an item in place at the front of the list
+template <typename T, typename Alloc>
+template <typename... Args>
+T& LinkedList<T, Alloc>::emplace_front(Args&&... args) {
+    linkFront(makeNode(std::forward<Args>(args)...));
+    return head->data;
+}
+
+// Construct an item in place at the back of the list
+template <typename T, typename Alloc>
+template <typename... Args>
+T& LinkedList<T, Alloc>::emplace_back(Args&&... args) {
+    linkBack(makeNode(std::forward<Args>(args)...));
+    return tail->data;
+}
+
 // Remove an item from the front of the list
-template <typename T>
-T LinkedList<T>::pop_front() {
+template <typename T, typename Alloc>
+T LinkedList<T, Alloc>::pop_front() {
     if (count == 0) throw out_of_range("Attempt to pop from empty list");
     Node *temp = head;
-    T data;
+    T data(std::move(temp->data));
     head = head->next;
     if (head != NULL) head->prev = NULL; // *** then set head's prev ptr to NULL
     else tail = NULL;
-    data = temp->data;
-    delete temp;
+    freeNode(temp);
     count--;
     return data;
 }
 
 // Remove an item from the back of the list
-template <typename T>
-T LinkedList<T>::pop_back() {
+template <typename T, typename Alloc>
+T LinkedList<T, Alloc>::pop_back() {
     if (count == 0) throw out_of_range("Attempt to pop from empty list");
     Node *temp = tail;
-    T data;
+    T data(std::move(temp->data));
     // *** Need to reset tail to point to the prev list node
     tail = tail->prev;
     if (tail != NULL) tail->next = NULL;
     else head = NULL;
-    data = temp->data;
-    delete temp;
+    freeNode(temp);
     count--;
     return data;
 }
 
 // Remove an item from (the back of) the list
-template <typename T>
-T LinkedList<T>::pop() {
+template <typename T, typename Alloc>
+T LinkedList<T, Alloc>::pop() {
     return pop_back();
 }
 
 // Return data from first list element
-template <typename T>
-T LinkedList<T>::peek_front() {
+template <typename T, typename Alloc>
+T& LinkedList<T, Alloc>::peek_front() {
     if (count == 0) throw out_of_range("Attempt to peek at empty list");
     return head->data;
 }
 
 // Return data from last list element
-template <typename T>
-T LinkedList<T>::peek_back() {
+template <typename T, typename Alloc>
+T& LinkedList<T, Alloc>::peek_back() {
     if (count == 0) throw out_of_range("Attempt to peek at empty list");
     return tail->data;
 }
 
 // Return data from last list element
-template <typename T>
-T LinkedList<T>::peek() {
+template <typename T, typename Alloc>
+T& LinkedList<T, Alloc>::peek() {
     return peek_back();
 }
 
-// Insert an item at a specified position in the list
-template <typename T>
-void LinkedList<T>::insertAt(unsigned int pos, T data) {
-    if (pos > count) throw out_of_range("Attempt to insert beyond bounds");
+// Return data from first list element
+template <typename T, typename Alloc>
+const T& LinkedList<T, Alloc>::peek_front() const {
+    if (count == 0) throw out_of_range("Attempt to peek at empty list");
+    return head->data;
+}
+
+// Return data from last list element
+template <typename T, typename Alloc>
+const T& LinkedList<T, Alloc>::peek_back() const {
+    if (count == 0) throw out_of_range("Attempt to peek at empty list");
+    return tail->data;
+}
+
+// Return data from last list element
+template <typename T, typename Alloc>
+const T& LinkedList<T, Alloc>::peek() const {
+    return peek_back();
+}
+
+// Link a new node in at a specified position in the list
+// The position must already have been bounds checked.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::linkAt(unsigned int pos, Node *newNode) {
     Node *pCurr;
-    Node *newNode;
 
-    newNode = new Node(data);
     if (pos == 0) {
-        if (head != NULL) head->prev = newNode; // *** then set the old head's prev ptr to the new node
-        else tail = newNode;
-        newNode->next = head;
-        head = newNode;
+        linkFront(newNode);
     } else if (pos == count) {
-        tail->next = newNode;
-        // *** Need to set the new node's prev ptr to the current tail
-        newNode->prev = tail;
-        tail = newNode;
+        linkBack(newNode);
     } else {
         pCurr = head;
         for (unsigned int i = 0; i < pos-1; i++) {
@@ -257,13 +473,27 @@ void LinkedList<T>::insertAt(unsigned int pos, T data) {
         // Need to set the new node's prev ptr to the current node
         newNode->prev = pCurr;
         pCurr->next = newNode;
+        count++;
     }
-    count++;
+}
+
+// Insert an item at a specified position in the list
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::insertAt(unsigned int pos, const T& data) {
+    if (pos > count) throw out_of_range("Attempt to insert beyond bounds");
+    linkAt(pos, makeNode(data));
+}
+
+// Move an item to a specified position in the list
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::insertAt(unsigned int pos, T&& data) {
+    if (pos > count) throw out_of_range("Attempt to insert beyond bounds");
+    linkAt(pos, makeNode(std::move(data)));
 }
 
 // Delete an item at a specified position
-template <typename T>
-void LinkedList<T>::deleteAt(unsigned int pos) {
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::deleteAt(unsigned int pos) {
     if (pos < 0 || pos >= count) throw out_of_range("Attempt to delete beyond bounds");
     Node *pCurr;
     Node *temp;
@@ -279,15 +509,15 @@ void LinkedList<T>::deleteAt(unsigned int pos) {
         pCurr->next = temp->next;
         // *** Need to set the prev ptr of the node after temp to the current node
         temp->next->prev = pCurr;
-        delete temp;
+        freeNode(temp);
         count--;
     }
 }
 
 // Delete a particular value from list
 // Returns true or false based on whether value was found.
-template <typename T>
-bool LinkedList<T>::remove(T data) {
+template <typename T, typename Alloc>
+bool LinkedList<T, Alloc>::remove(const T& data) {
     Node *pCurr = head;
 
     while (pCurr != NULL && pCurr->data != data) {
@@ -299,15 +529,15 @@ bool LinkedList<T>::remove(T data) {
     else pCurr->prev->next = pCurr->next; // *** Need to set the previous node's next ptr to whatever the current node points to as next
     if (tail == pCurr) tail = pCurr->prev; // *** then set tail to be whatever node comes before the current node
     else pCurr->next->prev = pCurr->prev; // *** then set the next node's prev ptr to whatever comes before the current node
-    delete pCurr;
+    freeNode(pCurr);
     count--;
     return true;
 }
 
 // Find out if the list contains a particular value
 // Returns true or false based on whether value was found.
-template <typename T>
-bool LinkedList<T>::contains(T data) {
+template <typename T, typename Alloc>
+bool LinkedList<T, Alloc>::contains(const T& data) const {
     Node *pCurr = head;
 
     while (pCurr != NULL) {
@@ -318,8 +548,8 @@ bool LinkedList<T>::contains(T data) {
 }
 
 // Overload of [] operator
-template <typename T>
-T& LinkedList<T>::operator[](const unsigned int pos) {
+template <typename T, typename Alloc>
+T& LinkedList<T, Alloc>::operator[](const unsigned int pos) {
     if (pos >= count) {
         stringstream strm;
         strm << "Attempted access beyond bounds [" << pos << "]";
@@ -334,9 +564,147 @@ T& LinkedList<T>::operator[](const unsigned int pos) {
     return p->data;
 }
 
+// Link a new node in front of pNext (or at the back if pNext is NULL)
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::linkBefore(Node *pNext, Node *newNode) {
+    if (pNext == NULL) {
+        linkBack(newNode);
+        return;
+    }
+    newNode->next = pNext;
+    newNode->prev = pNext->prev;
+    if (pNext->prev != NULL) pNext->prev->next = newNode;
+    else head = newNode;
+    pNext->prev = newNode;
+    count++;
+}
+
+// Insert an item in front of the one an iterator refers to
+// Returns an iterator to the new item.
+template <typename T, typename Alloc>
+typename LinkedList<T, Alloc>::iterator LinkedList<T, Alloc>::insert(const_iterator pos, const T& data) {
+    Node *newNode = makeNode(data);
+    linkBefore(pos.node, newNode);
+    return iterator(newNode, this);
+}
+
+// Move an item in front of the one an iterator refers to
+// Returns an iterator to the new item.
+template <typename T, typename Alloc>
+typename LinkedList<T, Alloc>::iterator LinkedList<T, Alloc>::insert(const_iterator pos, T&& data) {
+    Node *newNode = makeNode(std::move(data));
+    linkBefore(pos.node, newNode);
+    return iterator(newNode, this);
+}
+
+// Delete the item an iterator refers to
+// Returns an iterator to the item that followed it.
+template <typename T, typename Alloc>
+typename LinkedList<T, Alloc>::iterator LinkedList<T, Alloc>::erase(const_iterator pos) {
+    Node *pCurr = pos.node;
+    if (pCurr == NULL) throw out_of_range("Attempt to erase end of list");
+    Node *pNext = pCurr->next;
+    if (head == pCurr) head = pNext;
+    else pCurr->prev->next = pNext;
+    if (tail == pCurr) tail = pCurr->prev;
+    else pNext->prev = pCurr->prev;
+    freeNode(pCurr);
+    count--;
+    return iterator(pNext, this);
+}
+
+// Detach the nodes first..last (inclusive) without freeing them
+// The caller adjusts count.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::unlinkRange(Node *first, Node *last) {
+    if (first->prev != NULL) first->prev->next = last->next;
+    else head = last->next;
+    if (last->next != NULL) last->next->prev = first->prev;
+    else tail = first->prev;
+    first->prev = NULL;
+    last->next = NULL;
+}
+
+// Link the detached nodes first..last (inclusive) in front of pNext
+// (or at the back if pNext is NULL). The caller adjusts count.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::linkRangeBefore(Node *pNext, Node *first, Node *last) {
+    Node *pPrev = (pNext == NULL) ? tail : pNext->prev;
+    first->prev = pPrev;
+    last->next = pNext;
+    if (pPrev != NULL) pPrev->next = first;
+    else head = first;
+    if (pNext != NULL) pNext->prev = last;
+    else tail = last;
+}
+
+// Move every item of other in front of pos, leaving other empty
+// No items are copied; this is constant time.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::splice(const_iterator pos, LinkedList& other) {
+    if (&other == this || other.head == NULL) return;
+    Node *first = other.head;
+    Node *last = other.tail;
+    other.head = other.tail = NULL;
+    linkRangeBefore(pos.node, first, last);
+    count += other.count;
+    other.count = 0;
+}
+
+// Move the item it refers to from other in front of pos
+// No items are copied; this is constant time.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::splice(const_iterator pos, LinkedList& other, const_iterator it) {
+    Node *p = it.node;
+    if (p == NULL) throw out_of_range("Attempt to splice end of list");
+    if (&other == this && (p == pos.node || p->next == pos.node)) return;
+    other.unlinkRange(p, p);
+    other.count--;
+    linkRangeBefore(pos.node, p, p);
+    count++;
+}
+
+// Move the items [first, last) from other in front of pos
+// No items are copied, but counting the range is linear when the
+// lists differ. pos must not lie inside the range.
+template <typename T, typename Alloc>
+void LinkedList<T, Alloc>::splice(const_iterator pos, LinkedList& other, const_iterator first, const_iterator last) {
+    if (first == last) return;
+    Node *pFirst = first.node;
+    Node *pLast = (last.node == NULL) ? other.tail : last.node->prev;
+    if (&other != this) {
+        unsigned int n = 1;
+        for (Node *p = pFirst; p != pLast; p = p->next) n++;
+        other.count -= n;
+        count += n;
+    }
+    other.unlinkRange(pFirst, pLast);
+    linkRangeBefore(pos.node, pFirst, pLast);
+}
+
+// Delete every item for which pred returns true, in a single pass
+// Returns the number of items deleted.
+template <typename T, typename Alloc>
+template <typename Pred>
+unsigned int LinkedList<T, Alloc>::remove_if(Pred pred) {
+    unsigned int removed = 0;
+    Node *pCurr = head;
+    while (pCurr != NULL) {
+        Node *pNext = pCurr->next;
+        if (pred(pCurr->data)) {
+            unlinkRange(pCurr, pCurr);
+            freeNode(pCurr);
+            count--;
+            removed++;
+        }
+        pCurr = pNext;
+    }
+    return removed;
+}
+
 #ifdef DEBUG
-template <typename T>
-bool LinkedList<T>::test() {
+template <typename T, typename Alloc>
+bool LinkedList<T, Alloc>::test() {
     int errors = 0;
     int tests = 0;
 
@@ -561,6 +929,65 @@ bool LinkedList<T>::test() {
         cout << "Passed: contains()\n";
     }
 
+    // Test iterators, insert(iterator, T) and erase(iterator)
+    tests++;
+    v.clear();
+    v.push_back(10);
+    v.push_back(12);
+    v.push_back(20);
+    LinkedList<int>::iterator it = lst.begin();
+    ++it;
+    it = lst.insert(++it, 12);
+    lst.erase(--it);
+    lst.insert(lst.end(), 30);
+    lst.erase(--lst.end());
+    int sum = 0;
+    for (const int& n : static_cast<const LinkedList<int>&>(lst)) sum += n;
+    if (!check(v, lst) || sum != 42) {
+        cout << "Error: iterators\n";
+        errors++;
+    } else {
+        cout << "Passed: iterators test\n";
+    }
+
+    // Test move constructor, move assignment and emplace functions
+    tests++;
+    LinkedList<int> lst3(lst2);
+    LinkedList<int> lst4(std::move(lst3));
+    LinkedList<int> lst5;
+    lst5 = std::move(lst4);
+    lst5.emplace_front(1);
+    lst5.emplace_back(2) = 3;
+    if (lst3.size() != 0 || lst4.size() != 0 || lst5.size() != 5 ||
+        lst5.peek_front() != 1 || lst5.peek_back() != 3) {
+        cout << "Error: move/emplace\n";
+        errors++;
+    } else {
+        cout << "Passed: move/emplace test\n";
+    }
+
+    // Test splice() and remove_if() functions
+    tests++;
+    LinkedList<int> lst6;
+    lst6.push(1).push(2).push(3).push(4);
+    lst5.splice(lst5.begin(), lst6, ++lst6.begin());
+    lst5.splice(lst5.end(), lst6, lst6.begin(), --lst6.end());
+    lst6.splice(lst6.begin(), lst5);
+    unsigned int odd = lst6.remove_if([](int n) { return n % 2 != 0; });
+    lst5.push(6);
+    lst6.splice(lst6.end(), lst5, --lst5.end());
+    v.clear();
+    v.push_back(2);
+    v.push_back(10);
+    v.push_back(4);
+    v.push_back(6);
+    if (!check(v, lst6) || lst5.size() != 0 || odd != 6 || lst6.peek_back() != 6) {
+        cout << "Error: splice/remove_if\n";
+        errors++;
+    } else {
+        cout << "Passed: splice/remove_if test\n";
+    }
+
     // Test clear() function
     lst.clear();
     tests++;
@@ -585,8 +1012,8 @@ bool LinkedList<T>::test() {
     return errors == 0;
 }
 
-template <typename T>
-bool LinkedList<T>::check(const vector<int>& v, const LinkedList<int>& lst) {
+template <typename T, typename Alloc>
+bool LinkedList<T, Alloc>::check(const vector<int>& v, const LinkedList<int>& lst) {
     if ((v.size() != lst.size()) || (lst.size() != lst.count)) return false;
     if (lst.count == 0 && (lst.head != NULL || lst.tail != NULL)) return false;
     if (lst.count != 0 && (lst.head == NULL || lst.tail == NULL)) return false;
@@ -5,44 +5,48 @@
     game.
 */
 #include "LinkedList.h"
+#include "BatchRunner.h"
 #include "Dungeon.h"
+#include "DungeonImage.h"
+#include "DungeonLoader.h"
+#include "DungeonServer.h"
+#include "GameSession.h"
 #include <cstdlib>
 #include <ctype.h>
-#include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <cstring>
 #include <vector>
 #include <cstddef>
+#include <thread>
+#include <utility>
 using std::cerr;
 using std::cin;
 using std::cout;
 using std::cout;
 using std::endl;
-using std::ifstream;
 using std::string;
 using std::vector;
 
-string toLowerCase(string);
-string toUpperCase(string);
-void processLine(Dungeon&, string&);
-string trim(string);
-void readFile(Dungeon&, const char*);
-void describeRoom(Room&);
-Item& findItem(Room& room, string nm);
+string toUpperCase(const string&);
 
 int main(int argc, char* argv[]) {
     //LinkedList<int>::test(); // calls LinkedList test function
-    LinkedList<Item> inv;
-    bool done = false;
-    char* buf = new char[500];
+    char line[CommandParser::MAX_LINE];
     const char* fileName = "dungeon.txt";
     int datafileCount = 0;
     int i;
     bool debug = false;
+    bool compile = false;
+    std::size_t textBudget = 0;
+    unsigned long port = 0;
+    const char* socketPath = NULL;
+    vector<const char*> scripts;
+    vector<const char*> scriptStreams;
+    BatchRunner::OutputMode batchOutput = BatchRunner::HASH;
+    unsigned int threads = std::thread::hardware_concurrency();
     bool error = false;
-    string action, object;
-    vector<string> commands;
 
     // create dungeon
     Dungeon dungeon;
@@ -51,13 +55,49 @@ int main(int argc, char* argv[]) {
     for (i=1; i<argc; i++) {
         if (strcmp(argv[i], "-d") == 0) {
             debug = true;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            compile = true;
+        } else if (strcmp(argv[i], "-m") == 0 && i+1 < argc) {
+            textBudget = strtoul(argv[++i], NULL, 10) * 1024 * 1024;
+            if (textBudget == 0) {
+                cerr << "Error: -m needs a budget for room text, in megabytes" << endl;
+                error = true;
+            }
+        } else if (strcmp(argv[i], "-p") == 0 && i+1 < argc) {
+            port = strtoul(argv[++i], NULL, 10);
+            if (port == 0 || port > 65535) {
+                cerr << "Error: -p needs a port number" << endl;
+                error = true;
+            }
+        } else if (strcmp(argv[i], "-u") == 0 && i+1 < argc) {
+            socketPath = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i+1 < argc) {
+            scripts.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i+1 < argc) {
+            scriptStreams.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i+1 < argc) {
+            i++;
+            if (strcmp(argv[i], "none") == 0) batchOutput = BatchRunner::DISCARD;
+            else if (strcmp(argv[i], "hash") == 0) batchOutput = BatchRunner::HASH;
+            else if (strcmp(argv[i], "text") == 0) batchOutput = BatchRunner::TEXT;
+            else {
+                cerr << "Error: -o needs none, hash or text" << endl;
+                error = true;
+            }
+        } else if (strcmp(argv[i], "-j") == 0 && i+1 < argc) {
+            threads = strtoul(argv[++i], NULL, 10);
+            if (threads == 0) {
+                cerr << "Error: -j needs a number of threads" << endl;
+                error = true;
+            }
         } else if ((strlen(argv[i]) > 0) && (argv[i][0] == '-')) {
             cerr << "Unrecognized option: " << argv[i] << endl;
             error = true;
         } else {
             if (datafileCount > 1) {
                 cerr << "Error: Multiple data files specified" << endl;
-                cerr << "Usage: " << argv[0] << " datafileName\n";
+                cerr << "Usage: " << argv[0] << " [-d] [-c] [-m textMegabytes] [-p port] [-u socketPath]\n"
+                     << "       [-r script] [-i stream] [-o none|hash|text] [-j threads] datafileName\n";
                 error = true;
             } else {
                 fileName = argv[i];
@@ -72,16 +112,25 @@ int main(int argc, char* argv[]) {
     }
 
     try {
-        // read in data file to populate dungeon
-        readFile(dungeon, fileName);
+        // compile the data file to an image and stop, if asked to
+        if (compile) {
+            compileFile(dungeon, fileName);
+            cout << "Compiled " << dungeon.rooms.size() << " rooms to "
+                 << DungeonImage::imageName(fileName) << endl;
+            return 0;
+        }
+
+        // read in data file (or its compiled image) to populate dungeon
+        readFile(dungeon, fileName, textBudget);
 
         // initialize dungeon
         if (dungeon.rooms.size() == 0) {
             throw string("Error: No rooms in dungeon");
         }
-        if (dungeon.currentRoom == "") {
+        if (dungeon.currentRoom.empty()) {
             dungeon.currentRoom = dungeon.rooms[0].id;
         }
+        dungeon.buildGraph();
         // display debugging info if requested
         if (debug) {
             cout << "Debugging information:\n";
@@ -89,141 +138,66 @@ int main(int argc, char* argv[]) {
             cout << "List of rooms:\n";
             for (unsigned int i=0; i<dungeon.rooms.size(); i++) {
                 Room& room = dungeon.rooms[i];
-                cout << "  Room #" << i << ": " << room.id << " (" << room.name << ")\n";
-                cout << "        " << room.description << "\n";
-                if (room.paths.size() > 0) cout << "  Paths:\n";
-                for (unsigned int k=0; k < room.paths.size(); k++) {
-                    Path& tempPath = room.paths[k];
+                cout << "  Room #" << i << ": " << room.id << " (" << dungeon.roomName(i) << ")\n";
+                cout << "        " << dungeon.roomDescription(i) << "\n";
+                if (room.pathCount > 0) cout << "  Paths:\n";
+                room.forEachPath([](const Path& tempPath) {
                     cout << "    Path: " << tempPath.direction << " to " << tempPath.to << '\n';
-                }
+                });
                 if (room.items.size() > 0) cout << "  Items:\n";
-                for (unsigned int m=0; m< room.items.size(); m++) {
-                    cout << "    " << room.items[m].description << '\n';
+                for (const Item& item : room.items) {
+                    cout << "    " << item.description << '\n';
                 }
             }
             cout << "Starting room: " << dungeon.currentRoom << endl;
+            cout << "Rooms reachable from starting room: "
+                 << dungeon.graph.countReachable(dungeon.findRoom(dungeon.currentRoom).index)
+                 << " of " << dungeon.graph.roomCount() << endl;
             cout << "And now... on to the game\n\n\n";
         }
 
-        // play the game
-        while (!done) {
-            cout << '\n';
-            Room& current = dungeon.getRoom(dungeon.currentRoom);
-            if (current == Room::NULL_ROOM) throw string("Error: Current room is unknown.\n");
-            describeRoom(current);
-            if (toLowerCase(current.id) == "outside") {
-                cout << "Congratulations! You have won the game.\n";
-                done = true;
-                break;
-            }
-            cout << "Enter command: ";
-            cin.getline(buf, 500, '\n');
-            string command(buf);
-            command = trim(toLowerCase(command));
-            commands.clear();
-            char* cstr = new char[command.length() + 1];
-            strcpy(cstr, command.c_str());
-            char* cmdPtr = strtok(cstr, " ");
-            while (cmdPtr != NULL) {
-                commands.push_back(string(cmdPtr));
-                cmdPtr = strtok(NULL, " ");
-            }
+        // play scripted games without a player, if asked to
+        if (!scripts.empty() || !scriptStreams.empty()) {
+            BatchRunner batch(dungeon, batchOutput, threads);
+            for (const char* script : scripts) batch.addScript(script);
+            for (const char* stream : scriptStreams) batch.addStream(stream);
+            batch.run(cout);
+            return 0;
+        }
 
-            if (commands.size() == 0 || commands.size() > 2) cout << "Command not understood\n";
-            else { // command is one or two tokens long
-                action = commands[0];
-                object = (commands.size() > 1) ? commands[1] : "";
-                if (action == "go") {
-                    action = object;
-                    object = "";
-                }
+        // serve players over sockets until stopped, if asked to
+        if (port != 0 || socketPath != NULL) {
+            DungeonServer server(dungeon);
+            if (port != 0) server.listenTcp(port);
+            if (socketPath != NULL) server.listenUnix(socketPath);
+            cout << "Serving " << dungeon.rooms.size() << " rooms";
+            if (port != 0) cout << " on port " << port;
+            if (socketPath != NULL) cout << " on " << socketPath;
+            cout << endl;
+            server.run();
+            return 0;
+        }
 
-                if (action == "drop") {
-                    if (object == "") cout << "You must specify an object to drop\n";
-                    else {
-                        for (i=inv.size()-1; i>=0; i--) {
-                            Item item = inv[i];
-                            if (item.name == object || object == "all") {
-                                current.items.push(item);
-                                inv.remove(item);
-                                if (object != "all") break;
-                            }
-                        }
-                        Item item1 = findItem(current, "bike");
-                        Item item2 = findItem(current, "instructor");
-                        if (item1 != Item::NULL_ITEM && item2 != Item::NULL_ITEM) {
-                            current.items.remove(item1);
-                            current.items.remove(item2);
-                            cout << "The instructor wakes up and gets on the bike.\n";
-                            cout << "Before you can ask him what's happening, he pedals off\n";
-                            cout << "and leaves the building going south from the east hall.\n";
-                            Path p("s", "outside");
-                            Room& r = dungeon.getRoom("east hall south");
-                            r.paths.push(p);
-                            string old(" locked");
-                            std::size_t found = r.description.rfind(old);
-                            if (found != std::string::npos) {
-                                (r.description).replace(found, old.length(), " now unlocked");
-                            }
-                            r.visited = false;
-                        }
-                    }
-                } else if (action == "take") {
-                    if (object == "") cout << "You must specify an object to take\n";
-                    else {
-                        for (i=current.items.size()-1; i>=0; i--) {
-                            Item item = current.items[i];
-                            if (item.name == object || object == "all") {
-                                inv.push(item);
-                                current.items.remove(item);
-                                break;
-                            }
-                        }
-                    }
-                } else if (action == "inv") {
-                    cout << "You are carrying: ";
-                    if (inv.size() == 0) cout << "nothing";
-                    else {
-                        for (unsigned i=0; i<inv.size(); i++) {
-                            if (i > 0) cout << ", ";
-                            cout << inv[i].name;
-                        }
-                    }
-                    cout << '\n';
-                } else if (action == "quit") {
-                        done = true;
-                } else if (action == "exit") {
-                        cout << "Use 'quit' to end the game.\n";
-                } else if (action == "help") {
-                        cout << "Commands are: help, quit, look, drop, take, go, inv, and the exit directions\n";
-                } else if (action == "look") {
-                        current.visited = false;
-                } else if (action == "xyzzy") {
-                    // check for regalia in inventory
-                    bool hasRegalia = false;
-                    for (unsigned int i=0; i<inv.size(); i++) {
-                        if (inv[i].name == "regalia") hasRegalia = true;
-                    }
-                    if (hasRegalia) {
-                        if (dungeon.currentRoom == "A-1342") dungeon.currentRoom = "A-1374";
-                        else if (dungeon.currentRoom == "A-1374") dungeon.currentRoom = "A-1342";
-                        else cout << "Nothing happens.\n";
-                    } else {
-                        cout << "Does this look like a colossal cave?\n";
-                    }
-                } else {
-                        Path& path = current.getPath(action);
-                        if (path == Path::NULL_PATH) {
-                            cout << "Unknown command. Try again.\n";
-                        } else {
-                            Room& room = dungeon.getRoom(path.to);
-                            if (room == Room::NULL_ROOM) {
-                                cout << "Path doesn't lead to a known room.\n";
-                            } else {
-                                dungeon.currentRoom = room.id;
-                            }
-                        }
-                }
+        // play the game, writing out each command's output in one go
+        GameSession session(dungeon);
+        string output;
+        StringOutput buffer(&output);
+        std::ostream out(&buffer);
+        while (true) {
+            session.prompt(out);
+            cout.write(output.data(), output.size()).flush();
+            output.clear();
+            if (session.done) break;
+            if (!cin.getline(line, sizeof line)) {
+                if (cin.eof() && cin.gcount() == 0) break;
+                // a line too long for the buffer: use what fits
+                cin.clear();
+                cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            }
+            session.perform(line, out);
+            if (session.done) {
+                cout << output;
+                break;
             }
         }
         cout << "Thanks for playing. Visit again soon.\n";
@@ -233,142 +207,9 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
-// routine to process a dungeon data file
-// this will throw an exception if it has any problems
-void readFile(Dungeon& dungeon, const char* filename) {
-    ifstream ifile(filename);
-    if (!ifile) {
-        throw string("Error: Could not open data file");
-    }
-    char buf[2000];
-    string linein, previousLine;
-    do {
-        ifile.getline(buf, 2000, '\n');
-        if (ifile.eof()) break;
-        if (!ifile) {
-            throw string("Error: Problem reading data file");
-        }
-        string temp(buf);
-        if (temp.length() == 0) continue;
-        string start = temp.substr(0,5);
-        if (start=="ROOM:" || start=="PATH:" || start=="INIT:" || start=="ITEM:") {
-            processLine(dungeon, previousLine);
-            previousLine = "";
-        }
-        if (previousLine.length() > 0) previousLine = previousLine + " ";
-        previousLine = previousLine + trim(temp);
-    } while (!ifile.eof());
-    processLine(dungeon, previousLine);
-    ifile.close();
-}
-// routine to process one line of a dungeon data file
-// this will throw an exception if it has any problems
-void processLine(Dungeon& dungeon, string& line) {
-    string start = line.substr(0,5);
-    string field1, field2, field3;
-    field1 = field2 = field3 = "";
-    if (start == "ROOM:" || start == "PATH:" || start == "ITEM:") {
-        int pos1 = line.find(':', 0);
-        if (pos1==(int)string::npos) {
-            throw string("Error: Problem parsing data file");
-        }
-        int pos2 = line.find(':', pos1+1);
-        if (pos2==(int)string::npos) {
-            throw string("Error: Problem parsing data file");
-        }
-        int pos3 = line.find(':', pos2+1);
-        if (pos3==(int)string::npos) {
-            throw string("Error: Problem parsing data file");
-            return;
-        }
-        field1 = line.substr(pos1+1, pos2-pos1-1);
-        field1 = trim(field1);
-        field2 = line.substr(pos2+1, pos3-pos2-1);
-        field2 = trim(field2);
-        field3 = line.substr(pos3+1, line.length()-pos3-1);
-        field3 = trim(field3);
-        if (start == "ROOM:") {
-            if (dungeon.getRoom(field1) != Room::NULL_ROOM) {
-                throw string("Error: Duplicate room ID found in input file");
-            }
-            dungeon.rooms.push(Room(field1, field2, field3));
-        } else if (start == "PATH:") {
-            Room& room = dungeon.getRoom(field2);
-            if (room == Room::NULL_ROOM) {
-                throw string("Error: Path from unknown room encountered in input file");
-            }
-            Path& path = room.getPath(field1);
-            if (path != Path::NULL_PATH) {
-                throw string("Error: Duplicate path source encountered in input file");
-            }
-            room.paths.push(Path(field1, field3));
-        } else { // start must be "ITEM:"
-            Room& room = dungeon.getRoom(field3);
-            if (room == Room::NULL_ROOM) {
-                throw string("Error: Item placed in unknown room");
-            } else {
-                room.items.push(Item(field1, field2, field3));
-            }
-        }
-    } else if (start == "INIT:") {
-        field2 = line.substr(5);
-        field2 = trim(field2);
-        dungeon.currentRoom = trim(field2);
-    }
-    return;
-}
-
-// eliminates spaces from beginning and end of a string
-string trim(string src) {
-    string s(src);
-    int pos1 = s.find_first_not_of(" \t\n");
-    int pos2 = s.find_last_not_of(" \t\n");
-    if ((pos1 != (int)string::npos) && (pos2 != (int)string::npos)) {
-        s = s.substr(pos1,pos2-pos1+1);
-    }
-    return s;
-}
-
-// prints room description
-// diplays short description if room is marked as
-// visited and long description otherwise
-void describeRoom(Room& room) {
-    cout << "You are in " << room.id << '\n';
-    if (!room.visited) cout << room.description << '\n';
-    if (room.paths.size() == 0) {
-        cout << "There are no exits\n";
-    } else {
-        for (unsigned int i=0; i< room.items.size(); i++) {
-            cout << room.items[i].description << '\n';
-        }
-        cout << "Exits are: ";
-        for (unsigned int i=0; i< room.paths.size(); i++) {
-            if (i > 0) cout << ", ";
-            cout << room.paths[i].direction;
-        }
-        cout << endl;
-    }
-    room.visited = true;
-}
-
-// converts a string to all lower case
-string toLowerCase(string src) {
-    string s(src);
-    for (int i=0; i<(int)s.length(); i++) s[i] = tolower(s[i]);
-    return s;
-}
-
 // converts a string to all upper case
-string toUpperCase(string src) {
+string toUpperCase(const string& src) {
     string s(src);
     for (int i=0; i<(int)s.length(); i++) s[i] = toupper(s[i]);
     return s;
 }
-
-Item& findItem(Room& room, string nm) {
-    for (unsigned i=0; i< room.items.size(); i++) {
-        if (room.items[i].name == nm) return room.items[i];
-    }
-    return Item::NULL_ITEM;
-}
-
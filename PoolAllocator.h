@@ -0,0 +1,127 @@
+/*
+    PoolAllocator.h
+
+    Contains the PoolAllocator implementation. A PoolAllocator is a
+    standard allocator that hands out single objects from large slabs
+    and keeps freed objects on a free list for reuse, so that node
+    based containers such as LinkedList do not hit the heap for every
+    insert and remove.
+
+    Each thread has its own free list for each object type. Slabs are
+    never returned to the system; they are recycled for the life of
+    the program.
+*/
+
+#ifndef __POOL_ALLOCATOR_H__
+#define __POOL_ALLOCATOR_H__
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+template <typename U>
+class PoolAllocator {
+private:
+    // A free slot holds the link to the next free slot in its first word.
+    struct FreeSlot {
+        FreeSlot *next;
+    };
+    // Slabs are recorded in one global list so that they stay reachable.
+    struct Slab {
+        Slab *next;
+    };
+    static const std::size_t MIN_SLAB = 16;
+    static const std::size_t MAX_SLAB = 4096;
+    static std::size_t slotSize() {
+        std::size_t align = alignof(U) > alignof(FreeSlot) ? alignof(U) : alignof(FreeSlot);
+        std::size_t size = sizeof(U) > sizeof(FreeSlot) ? sizeof(U) : sizeof(FreeSlot);
+        return (size + align - 1) / align * align;
+    }
+    static std::size_t slabHeader() {
+        std::size_t align = alignof(U) > alignof(Slab) ? alignof(U) : alignof(Slab);
+        return (sizeof(Slab) + align - 1) / align * align;
+    }
+    static FreeSlot*& freeList() {
+        static thread_local FreeSlot *head = NULL;
+        return head;
+    }
+    static std::size_t& nextSlab() {
+        static thread_local std::size_t slots = MIN_SLAB;
+        return slots;
+    }
+    static void refill();
+public:
+    typedef U value_type;
+    typedef U* pointer;
+    typedef std::size_t size_type;
+    template <typename V> struct rebind { typedef PoolAllocator<V> other; };
+
+    PoolAllocator() {}
+    template <typename V> PoolAllocator(const PoolAllocator<V>&) {}
+
+    U* allocate(std::size_t n);
+    void deallocate(U* p, std::size_t n);
+    void deallocate_chain(U* first, U* last);
+
+    template <typename V> bool operator==(const PoolAllocator<V>&) const { return true; }
+    template <typename V> bool operator!=(const PoolAllocator<V>&) const { return false; }
+};
+
+// Carve a new slab into free slots. Each slab on a thread is twice the
+// size of the one before it, up to MAX_SLAB slots.
+template <typename U>
+void PoolAllocator<U>::refill() {
+    static std::mutex slabLock;
+    static Slab *slabs = NULL;
+
+    std::size_t slots = nextSlab();
+    if (slots < MAX_SLAB) nextSlab() = slots * 2;
+    char *block = static_cast<char*>(::operator new(slabHeader() + slots * slotSize()));
+    Slab *slab = reinterpret_cast<Slab*>(block);
+    {
+        std::lock_guard<std::mutex> guard(slabLock);
+        slab->next = slabs;
+        slabs = slab;
+    }
+    char *p = block + slabHeader();
+    FreeSlot *head = freeList();
+    for (std::size_t i=slots; i>0; i--) {
+        FreeSlot *slot = reinterpret_cast<FreeSlot*>(p + (i-1) * slotSize());
+        slot->next = head;
+        head = slot;
+    }
+    freeList() = head;
+}
+
+// Allocate storage for n objects; single objects come from the pool
+template <typename U>
+U* PoolAllocator<U>::allocate(std::size_t n) {
+    if (n != 1) return static_cast<U*>(::operator new(n * sizeof(U)));
+    if (freeList() == NULL) refill();
+    FreeSlot *slot = freeList();
+    freeList() = slot->next;
+    return reinterpret_cast<U*>(slot);
+}
+
+// Return storage for n objects; single objects go back on the free list
+template <typename U>
+void PoolAllocator<U>::deallocate(U* p, std::size_t n) {
+    if (n != 1) {
+        ::operator delete(p);
+        return;
+    }
+    FreeSlot *slot = reinterpret_cast<FreeSlot*>(p);
+    slot->next = freeList();
+    freeList() = slot;
+}
+
+// Return a whole chain of single objects in constant time. The objects
+// must already be linked through a pointer stored in their first word,
+// from first to last, which is exactly the shape of the free list.
+template <typename U>
+void PoolAllocator<U>::deallocate_chain(U* first, U* last) {
+    reinterpret_cast<FreeSlot*>(last)->next = freeList();
+    freeList() = reinterpret_cast<FreeSlot*>(first);
+}
+
+#endif
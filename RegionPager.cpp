@@ -0,0 +1,91 @@
+/*
+    RegionPager.cpp
+
+    This is the implementation file for a RegionPager object.
+*/
+
+#include "RegionPager.h"
+#include <utility>
+
+RegionPager::RegionPager(unsigned int sourceRooms, Source source, std::size_t budget)
+    : rooms(sourceRooms), sourceRooms(sourceRooms), source(std::move(source)), budget(budget), bytes(0) {}
+
+unsigned int RegionPager::roomCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return rooms;
+}
+
+// Add a room after the last one
+void RegionPager::appendRoom(string name, string description) {
+    std::lock_guard<std::mutex> guard(lock);
+    appendedNames.push_back(std::move(name));
+    appendedDescriptions.push_back(std::move(description));
+    rooms++;
+}
+
+string RegionPager::name(unsigned int room) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (room >= rooms) return "";
+    if (room >= sourceRooms) return appendedNames[room - sourceRooms];
+    return fetch(room / REGION_SIZE).names[room % REGION_SIZE];
+}
+
+string RegionPager::description(unsigned int room) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (room >= rooms) return "";
+    if (room >= sourceRooms) return appendedDescriptions[room - sourceRooms];
+    return fetch(room / REGION_SIZE).descriptions[room % REGION_SIZE];
+}
+
+unsigned int RegionPager::residentRegions() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return resident.size();
+}
+
+std::size_t RegionPager::residentBytes() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return bytes;
+}
+
+// Make a region resident and the most recently used one
+// The caller must hold the lock.
+RegionPager::Region& RegionPager::fetch(unsigned int region) {
+    std::unordered_map<unsigned int, Region>::iterator it = resident.find(region);
+    if (it != resident.end()) {
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return it->second;
+    }
+    // load may throw, so the region is only made resident once it is whole
+    Region loaded;
+    load(region, loaded);
+    Region& r = resident.emplace(region, std::move(loaded)).first->second;
+    lru.push_front(region);
+    r.lru = lru.begin();
+    bytes += r.bytes;
+    evict(region);
+    return r;
+}
+
+// Read a region's text from the source
+void RegionPager::load(unsigned int region, Region& r) {
+    unsigned int first = region * REGION_SIZE;
+    unsigned int count = (sourceRooms - first < REGION_SIZE) ? sourceRooms - first : REGION_SIZE;
+    r.names.resize(count);
+    r.descriptions.resize(count);
+    r.bytes = 0;
+    for (unsigned int i=0; i<count; i++) {
+        source(first + i, r.names[i], r.descriptions[i]);
+        r.bytes += 2 * sizeof(string) + r.names[i].size() + r.descriptions[i].size();
+    }
+}
+
+// Drop least recently used regions, other than keep, until the text
+// held fits the budget
+void RegionPager::evict(unsigned int keep) {
+    while (bytes > budget && !lru.empty() && lru.back() != keep) {
+        unsigned int victim = lru.back();
+        bytes -= resident[victim].bytes;
+        lru.pop_back();
+        resident.erase(victim);
+    }
+}
@@ -0,0 +1,71 @@
+/*
+    RegionPager.h
+
+    This is the header file for a RegionPager object. A RegionPager
+    keeps the names and descriptions of a dungeon's rooms out of memory
+    until they are needed.
+
+    Rooms are grouped into regions of REGION_SIZE consecutive rooms.
+    A region's text is read from its source (normally a compiled
+    dungeon image) the first time one of its rooms is asked about, and
+    the least recently used regions are dropped again when the text
+    held goes over the memory budget. Room text never changes once
+    paged, since each game keeps its own changes, so a dropped region
+    is simply read from the source again. Rooms appended after the
+    source's are few and stay in memory.
+*/
+
+#ifndef __REGION_PAGER_H__
+#define __REGION_PAGER_H__
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using std::string;
+
+class RegionPager {
+public:
+    // Fills in the name and description of one room from the source
+    typedef std::function<void(unsigned int room, string& name, string& description)> Source;
+
+    RegionPager(unsigned int sourceRooms, Source source, std::size_t budget);
+    RegionPager(const RegionPager&) = delete;
+    RegionPager& operator=(const RegionPager&) = delete;
+
+    unsigned int roomCount() const;
+    void appendRoom(string name, string description);
+    string name(unsigned int room);
+    string description(unsigned int room);
+
+    unsigned int residentRegions() const;
+    std::size_t residentBytes() const;
+
+    static const unsigned int REGION_SIZE = 256;
+private:
+    struct Region {
+        std::vector<string> names;
+        std::vector<string> descriptions;
+        std::size_t bytes;
+        std::list<unsigned int>::iterator lru;
+    };
+    Region& fetch(unsigned int region);
+    void load(unsigned int region, Region& r);
+    void evict(unsigned int keep);
+
+    unsigned int rooms;
+    unsigned int sourceRooms;
+    Source source;
+    std::size_t budget;
+    std::size_t bytes;
+    std::unordered_map<unsigned int, Region> resident;
+    std::list<unsigned int> lru;                // most recently used first
+    std::vector<string> appendedNames;          // rooms from sourceRooms on
+    std::vector<string> appendedDescriptions;
+    mutable std::mutex lock;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+    RoomRenderer.cpp
+
+    This is the implementation file for a RoomRenderer object.
+*/
+
+#include "RoomRenderer.h"
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+const unsigned int RoomRenderer::MAX_CACHED;
+
+RoomRenderer::RoomRenderer(const Dungeon& dungeon) : dungeon(dungeon) {}
+
+void RoomRenderer::render(const WorldOverlay& world, unsigned int room, bool withDescription, ostream& out) {
+    unsigned int revision = world.revision(room);
+    if (revision == 0) {
+        // unchanged, so it reads the same in every session's world
+        RoomTextCache::Ref shared = dungeon.roomText.find(room);
+        if (!shared) {
+            std::shared_ptr<RoomTextCache::Text> made = std::make_shared<RoomTextCache::Text>();
+            fill(*made, world, room);
+            shared = dungeon.roomText.keep(room, std::move(made));
+        }
+        write(*shared, withDescription, out);
+        return;
+    }
+
+    std::vector<Block>::iterator it = blocks.begin();
+    while (it != blocks.end() && it->room != room) ++it;
+    if (it == blocks.end()) {
+        // take a free slot, or the least recently shown room's
+        if (blocks.size() < MAX_CACHED) blocks.push_back(Block());
+        it = blocks.end() - 1;
+        it->room = room;
+        it->revision = revision;
+        fill(it->rendered, world, room);
+    } else if (it->revision != revision) {
+        it->revision = revision;
+        fill(it->rendered, world, room);
+    }
+    std::rotate(blocks.begin(), it, it + 1);
+    write(blocks.front().rendered, withDescription, out);
+}
+
+// Write rendered text, leaving the description out if asked to
+void RoomRenderer::write(const RoomTextCache::Text& rendered, bool withDescription, ostream& out) {
+    const string& text = rendered.text;
+    if (withDescription) {
+        out.write(text.data(), text.size());
+    } else {
+        out.write(text.data(), rendered.descriptionStart);
+        out.write(text.data() + rendered.descriptionEnd, text.size() - rendered.descriptionEnd);
+    }
+}
+
+// Put together the text describing a room, as the world has it now
+void RoomRenderer::fill(RoomTextCache::Text& rendered, const WorldOverlay& world, unsigned int room) {
+    string& text = rendered.text;
+    text.clear();
+    text += "You are in ";
+    text += dungeon.rooms[room].id.str();
+    text += '\n';
+    rendered.descriptionStart = text.size();
+    text += world.roomDescription(room);
+    text += '\n';
+    rendered.descriptionEnd = text.size();
+    if (world.pathCount(room) == 0) {
+        text += "There are no exits\n";
+    } else {
+        world.forEachItem(room, [&text](const Item& item) {
+            text += item.description;
+            text += '\n';
+        });
+        text += "Exits are: ";
+        const char* separator = "";
+        world.forEachPath(room, [&separator, &text](const Path& path) {
+            text += separator;
+            text += path.direction.str();
+            separator = ", ";
+        });
+        text += '\n';
+    }
+}
@@ -0,0 +1,73 @@
+/*
+    RoomRenderer.h
+
+    This is the header file for a RoomRenderer object, and for the
+    StringOutput stream buffer that sessions render into.
+
+    A RoomRenderer writes the text that describes a room (its heading,
+    description, items and exits) from text already put together, so
+    that showing a room costs a copy rather than a walk over its items
+    and exits. Rooms the session's WorldOverlay has not changed (those
+    at revision 0) are shared with every other session through the
+    dungeon's RoomTextCache. Only rooms this session has changed are
+    kept here, the MAX_CACHED most recently shown, and one is rendered
+    again when the WorldOverlay's revision of it changes, that is, when
+    its items, exits or description have.
+
+    A StringOutput appends whatever is written through it to a string.
+    A session's output for a command is collected there and written
+    out once, with a single flush, when the command is done.
+*/
+
+#ifndef __ROOM_RENDERER_H__
+#define __ROOM_RENDERER_H__
+
+#include "Dungeon.h"
+#include "RoomTextCache.h"
+#include "WorldOverlay.h"
+#include <cstddef>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+using std::ostream;
+using std::string;
+
+class StringOutput : public std::streambuf {
+public:
+    string* target;
+    explicit StringOutput(string* target = NULL) : target(target) {}
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) target->push_back((char)c);
+        return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        target->append(s, n);
+        return n;
+    }
+};
+
+class RoomRenderer {
+public:
+    // Number of changed rooms each renderer keeps rendered
+    static const unsigned int MAX_CACHED = 16;
+
+    explicit RoomRenderer(const Dungeon& dungeon);
+    // Writes a room as the player sees it, with its description or not
+    void render(const WorldOverlay& world, unsigned int room, bool withDescription, ostream& out);
+    unsigned int cachedRooms() const { return blocks.size(); }
+private:
+    struct Block {
+        unsigned int room;
+        unsigned int revision;          // WorldOverlay::revision when rendered
+        RoomTextCache::Text rendered;
+    };
+    const Dungeon& dungeon;
+    std::vector<Block> blocks;          // most recently shown first
+
+    void fill(RoomTextCache::Text& rendered, const WorldOverlay& world, unsigned int room);
+    static void write(const RoomTextCache::Text& rendered, bool withDescription, ostream& out);
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*
+    RoomTextCache.cpp
+
+    This is the implementation file for a RoomTextCache object.
+*/
+
+#include "RoomTextCache.h"
+#include <utility>
+
+const std::size_t RoomTextCache::MAX_BYTES;
+
+RoomTextCache::RoomTextCache() : bytes(0) {}
+
+// A room's text if it is held, made the most recently shown
+RoomTextCache::Ref RoomTextCache::find(unsigned int room) const {
+    std::lock_guard<std::mutex> guard(lock);
+    std::unordered_map<unsigned int, Entry>::iterator it = entries.find(room);
+    if (it == entries.end()) return Ref();
+    lru.splice(lru.begin(), lru, it->second.lru);
+    return it->second.text;
+}
+
+// Hold a room's text, unless another game got there first, and give
+// back the text that is held. Least recently shown rooms are dropped
+// until the text held fits MAX_BYTES.
+RoomTextCache::Ref RoomTextCache::keep(unsigned int room, Ref text) const {
+    std::lock_guard<std::mutex> guard(lock);
+    std::pair<std::unordered_map<unsigned int, Entry>::iterator, bool> added = entries.emplace(room, Entry());
+    Entry& entry = added.first->second;
+    if (!added.second) {
+        lru.splice(lru.begin(), lru, entry.lru);
+        return entry.text;
+    }
+    entry.text = std::move(text);
+    entry.bytes = sizeof(Entry) + sizeof(Text) + entry.text->text.size();
+    lru.push_front(room);
+    entry.lru = lru.begin();
+    bytes += entry.bytes;
+    while (bytes > MAX_BYTES && lru.back() != room) {
+        std::unordered_map<unsigned int, Entry>::iterator victim = entries.find(lru.back());
+        bytes -= victim->second.bytes;
+        lru.pop_back();
+        entries.erase(victim);
+    }
+    return entry.text;
+}
+
+// Drop every room's text, for when the dungeon's rooms change
+void RoomTextCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    entries.clear();
+    lru.clear();
+    bytes = 0;
+}
+
+unsigned int RoomTextCache::cachedRooms() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+std::size_t RoomTextCache::cachedBytes() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return bytes;
+}
@@ -0,0 +1,62 @@
+/*
+    RoomTextCache.h
+
+    This is the header file for a RoomTextCache object. A RoomTextCache
+    holds the text describing rooms as the dungeon itself has them,
+    rendered once and shared by every game played on it. A room that
+    no game has changed reads the same to every player, so a popular
+    room is put together once rather than once per player; rooms a
+    game has changed are left to that game's RoomRenderer.
+
+    The least recently shown rooms are dropped when the text held goes
+    over MAX_BYTES. Games may ask from several threads at once. The
+    lock covers only the lookup: text is rendered outside it, and a
+    room's text is never changed once kept, only dropped.
+*/
+
+#ifndef __ROOM_TEXT_CACHE_H__
+#define __ROOM_TEXT_CACHE_H__
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+using std::string;
+
+class RoomTextCache {
+public:
+    struct Text {
+        string text;                    // heading, description, then items and exits
+        std::size_t descriptionStart;
+        std::size_t descriptionEnd;
+    };
+    typedef std::shared_ptr<const Text> Ref;
+
+    RoomTextCache();
+    RoomTextCache(const RoomTextCache&) = delete;
+    RoomTextCache& operator=(const RoomTextCache&) = delete;
+
+    Ref find(unsigned int room) const;
+    Ref keep(unsigned int room, Ref text) const;
+    void clear();
+
+    unsigned int cachedRooms() const;
+    std::size_t cachedBytes() const;
+
+    static const std::size_t MAX_BYTES = 16u << 20;
+private:
+    struct Entry {
+        Ref text;
+        std::size_t bytes;
+        std::list<unsigned int>::iterator lru;
+    };
+    // guarded by lock
+    mutable std::unordered_map<unsigned int, Entry> entries;
+    mutable std::list<unsigned int> lru;    // most recently shown first
+    mutable std::size_t bytes;
+    mutable std::mutex lock;
+};
+
+#endif
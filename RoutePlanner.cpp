@@ -0,0 +1,195 @@
+/*
+    RoutePlanner.cpp
+
+    This is the implementation file for a RoutePlanner object.
+*/
+
+#include "RoutePlanner.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+const unsigned int RoutePlanner::NO_EDGE;
+const unsigned int RoutePlanner::PRECOMPUTE_MAX_ROOMS;
+const unsigned int RoutePlanner::PRECOMPUTE_TARGETS;
+const unsigned int RoutePlanner::TABLE_AFTER_REQUESTS;
+const std::size_t RoutePlanner::MAX_TABLE_BYTES;
+const unsigned int RoutePlanner::MAX_TRACKED_REQUESTS;
+
+RoutePlanner::RoutePlanner() : graph(NULL), tableBytes(0) {}
+
+// Forget everything about the previous graph and plan over a new one,
+// precomputing tables for its best connected rooms if it is small enough
+void RoutePlanner::reset(const DungeonGraph* newGraph) {
+    std::lock_guard<std::mutex> guard(lock);
+    graph = newGraph;
+    tables.clear();
+    building.clear();
+    tableBytes = 0;
+    requests.clear();
+    buildReverse();
+
+    unsigned int rooms = graph->roomCount();
+    if (rooms == 0 || rooms > PRECOMPUTE_MAX_ROOMS) return;
+
+    // the rooms with the most ways in are the likeliest destinations
+    std::vector<unsigned int> targets(rooms);
+    for (unsigned int r=0; r<rooms; r++) targets[r] = r;
+    unsigned int count = std::min<std::size_t>(std::min(rooms, PRECOMPUTE_TARGETS), MAX_TABLE_BYTES / tableSize());
+    std::partial_sort(targets.begin(), targets.begin() + count, targets.end(),
+        [this](unsigned int a, unsigned int b) {
+            unsigned int inA = revOffsets[a+1] - revOffsets[a];
+            unsigned int inB = revOffsets[b+1] - revOffsets[b];
+            return inA > inB || (inA == inB && a < b);
+        });
+    targets.resize(count);
+
+    std::vector<std::vector<unsigned int> > built(count);
+    unsigned int threads = std::max(1u, std::min(count, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (unsigned int t=0; t<threads; t++) {
+        workers.push_back(std::thread([this, t, threads, count, &targets, &built]() {
+            for (unsigned int i=t; i<count; i+=threads) buildTable(targets[i], built[i]);
+        }));
+    }
+    for (std::thread& worker : workers) worker.join();
+    for (unsigned int i=0; i<count; i++) {
+        tables[targets[i]] = std::make_shared<const std::vector<unsigned int> >(std::move(built[i]));
+    }
+    tableBytes = count * tableSize();
+}
+
+// Bytes held by one table
+std::size_t RoutePlanner::tableSize() const {
+    return (std::size_t)graph->roomCount() * sizeof(unsigned int);
+}
+
+// Index every edge by the room it leads to
+void RoutePlanner::buildReverse() {
+    unsigned int rooms = graph->roomCount();
+    unsigned int edges = graph->edgeCount();
+    edgeSource.assign(edges, 0);
+    revOffsets.assign(rooms + 1, 0);
+    revEdges.assign(edges, 0);
+    for (unsigned int r=0; r<rooms; r++) {
+        for (unsigned int e=graph->offsets[r]; e<graph->offsets[r+1]; e++) {
+            edgeSource[e] = r;
+            if (graph->targets[e] != DungeonGraph::NO_TARGET) revOffsets[graph->targets[e] + 1]++;
+        }
+    }
+    for (unsigned int r=0; r<rooms; r++) revOffsets[r+1] += revOffsets[r];
+    std::vector<unsigned int> fill(revOffsets.begin(), revOffsets.end() - 1);
+    for (unsigned int e=0; e<edges; e++) {
+        if (graph->targets[e] != DungeonGraph::NO_TARGET) revEdges[fill[graph->targets[e]]++] = e;
+    }
+}
+
+// Breadth-first search backwards from a destination, in scratch,
+// until from has been reached (or over every room, if from is not a
+// room); scratch.distance then gives each room reached its number of
+// moves to the destination. Every room nearer than from is reached.
+void RoutePlanner::searchBack(unsigned int to, unsigned int from, SearchScratch& scratch) const {
+    unsigned int rooms = graph->roomCount();
+    scratch.start(rooms);
+    scratch.visit(to, to, NO_EDGE);
+    scratch.queue.push_back(to);
+    for (unsigned int head=0; head<scratch.queue.size() && !(from < rooms && scratch.visited(from)); head++) {
+        unsigned int r = scratch.queue[head];
+        for (unsigned int i=revOffsets[r]; i<revOffsets[r+1]; i++) {
+            unsigned int e = revEdges[i];
+            unsigned int source = edgeSource[e];
+            if (!scratch.visited(source)) {
+                scratch.visit(source, r, e);
+                scratch.queue.push_back(source);
+            }
+        }
+    }
+}
+
+// The exit a shortest route takes from a room that searchBack reached:
+// the first of its exits that leads one move closer. This is the only
+// place that breaks ties, so tables and searches agree.
+unsigned int RoutePlanner::nextHop(unsigned int room, const SearchScratch& scratch) const {
+    for (unsigned int e=graph->offsets[room]; e<graph->offsets[room+1]; e++) {
+        unsigned int next = graph->targets[e];
+        if (next != DungeonGraph::NO_TARGET && scratch.visited(next) &&
+            scratch.distance[next] + 1 == scratch.distance[room]) return e;
+    }
+    return NO_EDGE;
+}
+
+// Record for every room that can reach a destination the exit that
+// starts a shortest route
+void RoutePlanner::buildTable(unsigned int to, std::vector<unsigned int>& table) const {
+    SearchScratch& scratch = SearchScratch::local();
+    searchBack(to, graph->roomCount(), scratch);
+    table.assign(graph->roomCount(), NO_EDGE);
+    for (unsigned int r : scratch.queue) {
+        if (r != to) table[r] = nextHop(r, scratch);
+    }
+}
+
+// Find the route a table would give, searching back from the
+// destination only as far as from
+bool RoutePlanner::search(unsigned int from, unsigned int to, std::vector<unsigned int>& edges) const {
+    SearchScratch& scratch = SearchScratch::local();
+    searchBack(to, from, scratch);
+    if (!scratch.visited(from)) return false;
+    for (unsigned int r = from; r != to; r = graph->targets[edges.back()]) edges.push_back(nextHop(r, scratch));
+    return true;
+}
+
+// Find a shortest route; edges receives the exits to take, in order
+// Returns false if to cannot be reached from from.
+bool RoutePlanner::findRoute(unsigned int from, unsigned int to, std::vector<unsigned int>& edges) const {
+    edges.clear();
+    Table table;
+    bool build = false;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (graph == NULL || from >= graph->roomCount() || to >= graph->roomCount()) return false;
+        std::unordered_map<unsigned int, Table>::const_iterator it = tables.find(to);
+        if (it != tables.end()) {
+            table = it->second;
+        } else if (building.count(to) == 0 && ++requests[to] >= TABLE_AFTER_REQUESTS &&
+                   tableBytes + tableSize() <= MAX_TABLE_BYTES) {
+            // claim the memory now, so other threads see the budget as spent
+            build = true;
+            building.insert(to);
+            requests.erase(to);
+            tableBytes += tableSize();
+        } else if (requests.size() > MAX_TRACKED_REQUESTS) {
+            requests.clear();
+        }
+    }
+
+    if (build) {
+        // build the whole table before anyone can see it
+        std::vector<unsigned int> built;
+        try {
+            buildTable(to, built);
+            table = std::make_shared<const std::vector<unsigned int> >(std::move(built));
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(lock);
+            building.erase(to);
+            tableBytes -= tableSize();
+            throw;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        building.erase(to);
+        tables.emplace(to, table);
+    }
+    if (!table) return search(from, to, edges);
+
+    for (unsigned int r = from; r != to; r = graph->targets[(*table)[r]]) {
+        if ((*table)[r] == NO_EDGE) return false;
+        edges.push_back((*table)[r]);
+    }
+    return true;
+}
+
+// Number of next-hop tables currently cached
+unsigned int RoutePlanner::tableCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return tables.size();
+}
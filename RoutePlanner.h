@@ -0,0 +1,75 @@
+/*
+    RoutePlanner.h
+
+    This is the header file for a RoutePlanner object. A RoutePlanner
+    finds shortest routes (fewest moves) over a DungeonGraph.
+
+    Routes to popular destinations come from next-hop tables: for a
+    destination t, the table gives, for every room, the exit to take
+    to get one step closer to t. Tables for the best connected rooms
+    are built in parallel when the planner is reset, as long as the
+    world is small enough; any destination asked for often enough gets
+    a table on demand, while the tables fit in MAX_TABLE_BYTES. Every
+    other route is found with a breadth-first search.
+
+    Where several routes are equally short, both ways pick the same
+    one: from each room it takes the first exit that leads a step
+    closer. So the route for a trip never depends on which tables
+    happen to exist, which other travellers decide.
+
+    Queries may come from several threads at once. The lock covers only
+    the bookkeeping: tables are built and searches run outside it, and
+    a finished table is published whole.
+*/
+
+#ifndef __ROUTE_PLANNER_H__
+#define __ROUTE_PLANNER_H__
+
+#include "DungeonGraph.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class RoutePlanner {
+public:
+    RoutePlanner();
+    void reset(const DungeonGraph* graph);
+    bool findRoute(unsigned int from, unsigned int to, std::vector<unsigned int>& edges) const;
+    unsigned int tableCount() const;
+
+    static const unsigned int NO_EDGE = 0xFFFFFFFFu;
+    // Tables are precomputed only for worlds up to this many rooms
+    static const unsigned int PRECOMPUTE_MAX_ROOMS = 200000;
+    // Number of best connected rooms that get a table up front
+    static const unsigned int PRECOMPUTE_TARGETS = 16;
+    // A destination gets its own table after this many requests
+    static const unsigned int TABLE_AFTER_REQUESTS = 3;
+    // Upper limit on the memory held by tables, so big worlds get fewer
+    static const std::size_t MAX_TABLE_BYTES = 64u << 20;
+    // Request counts are forgotten once this many destinations have one
+    static const unsigned int MAX_TRACKED_REQUESTS = 4096;
+private:
+    void buildReverse();
+    void buildTable(unsigned int to, std::vector<unsigned int>& table) const;
+    bool search(unsigned int from, unsigned int to, std::vector<unsigned int>& edges) const;
+    void searchBack(unsigned int to, unsigned int from, SearchScratch& scratch) const;
+    unsigned int nextHop(unsigned int room, const SearchScratch& scratch) const;
+    std::size_t tableSize() const;
+
+    const DungeonGraph* graph;
+    std::vector<unsigned int> edgeSource;   // room each edge leaves from
+    std::vector<unsigned int> revOffsets;   // incoming edges of room r are
+    std::vector<unsigned int> revEdges;     // revEdges[revOffsets[r]..revOffsets[r+1])
+    // filled in on demand by findRoute; guarded by lock
+    typedef std::shared_ptr<const std::vector<unsigned int> > Table;
+    mutable std::unordered_map<unsigned int, Table> tables;
+    mutable std::unordered_set<unsigned int> building;   // tables being built
+    mutable std::size_t tableBytes;                      // held or being built
+    mutable std::unordered_map<unsigned int, unsigned int> requests;
+    mutable std::mutex lock;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+    Symbol.cpp
+
+    This is the implementation file for a Symbol object and the
+    global symbol table behind it.
+
+    The table maps strings to ids with an open addressing (linear
+    probing) hash table, and ids back to strings through fixed-size
+    chunks that are never moved. Interning and lookup take a lock;
+    str() does not, since the string behind an id never changes once
+    the id has been handed out.
+*/
+
+#include "Symbol.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+class SymbolTable {
+public:
+    SymbolTable();
+    unsigned int intern(string_view name);
+    unsigned int lookup(string_view name);
+    const string& name(unsigned int id) const;
+    unsigned int size() const { return count.load(std::memory_order_acquire); }
+private:
+    static const unsigned int CHUNK_BITS = 12;
+    static const unsigned int CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const unsigned int MAX_CHUNKS = 1u << 16;
+    struct Slot {
+        unsigned int hash;
+        unsigned int id;    // EMPTY_SLOT if unused
+    };
+    static const unsigned int EMPTY_SLOT = 0xFFFFFFFFu;
+    static unsigned int hashName(string_view name);
+    unsigned int find(string_view name, unsigned int hash) const;
+    void grow();
+
+    std::shared_mutex lock;
+    std::vector<Slot> slots;
+    std::atomic<string*> chunks[MAX_CHUNKS];
+    std::atomic<unsigned int> count;
+};
+
+static SymbolTable& table() {
+    static SymbolTable symbols;
+    return symbols;
+}
+
+SymbolTable::SymbolTable() : count(0) {
+    for (unsigned int i=0; i<MAX_CHUNKS; i++) chunks[i].store(NULL, std::memory_order_relaxed);
+    Slot empty = { 0, EMPTY_SLOT };
+    slots.assign(1024, empty);
+    intern("");
+}
+
+// FNV-1a hash of a name
+unsigned int SymbolTable::hashName(string_view name) {
+    unsigned int hash = 2166136261u;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Return the id of name, or EMPTY_SLOT if it is not in the table
+// The caller must hold the lock.
+unsigned int SymbolTable::find(string_view name, unsigned int hash) const {
+    unsigned int mask = slots.size() - 1;
+    for (unsigned int i = hash & mask; slots[i].id != EMPTY_SLOT; i = (i + 1) & mask) {
+        if (slots[i].hash == hash && this->name(slots[i].id) == name) return slots[i].id;
+    }
+    return EMPTY_SLOT;
+}
+
+// Return the id of name, adding it to the table if necessary
+unsigned int SymbolTable::intern(string_view name) {
+    unsigned int hash = hashName(name);
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        unsigned int id = find(name, hash);
+        if (id != EMPTY_SLOT) return id;
+    }
+    std::unique_lock<std::shared_mutex> guard(lock);
+    unsigned int id = find(name, hash);
+    if (id != EMPTY_SLOT) return id;
+
+    id = count.load(std::memory_order_relaxed);
+    if ((id >> CHUNK_BITS) >= MAX_CHUNKS) throw string("Error: Symbol table is full");
+    string *chunk = chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+    if (chunk == NULL) {
+        chunk = new string[CHUNK_SIZE];
+        chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+    }
+    chunk[id & (CHUNK_SIZE - 1)] = name;
+    count.store(id + 1, std::memory_order_release);
+
+    if ((id + 1) * 2 > slots.size()) grow();
+    unsigned int mask = slots.size() - 1;
+    unsigned int i = hash & mask;
+    while (slots[i].id != EMPTY_SLOT) i = (i + 1) & mask;
+    slots[i].hash = hash;
+    slots[i].id = id;
+    return id;
+}
+
+// Return the id of name without adding it, or EMPTY_SLOT
+unsigned int SymbolTable::lookup(string_view name) {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return find(name, hashName(name));
+}
+
+// Return the string an id stands for
+const string& SymbolTable::name(unsigned int id) const {
+    return chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+}
+
+// Double the hash table and re-insert every id. The caller must hold
+// the lock exclusively.
+void SymbolTable::grow() {
+    std::vector<Slot> old;
+    old.swap(slots);
+    Slot empty = { 0, EMPTY_SLOT };
+    slots.assign(old.size() * 2, empty);
+    unsigned int mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == EMPTY_SLOT) continue;
+        unsigned int i = slot.hash & mask;
+        while (slots[i].id != EMPTY_SLOT) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+Symbol::Symbol(string_view name) : value(table().intern(name)) {}
+
+Symbol Symbol::lookup(string_view name) {
+    // the table's EMPTY_SLOT is the same value as NOT_FOUND
+    return Symbol(table().lookup(name));
+}
+
+unsigned int Symbol::count() {
+    return table().size();
+}
+
+const string& Symbol::str() const {
+    static const string none;
+    if (value == NOT_FOUND) return none;
+    return table().name(value);
+}
@@ -0,0 +1,46 @@
+/*
+    Symbol.h
+
+    This is the header file for a Symbol object. A Symbol is an
+    interned identifier (room id, direction, item name): each distinct
+    string is stored once in a global symbol table and is referred to
+    by a small integer, so comparing two symbols is an integer compare.
+*/
+
+#ifndef __SYMBOL_H__
+#define __SYMBOL_H__
+
+#include <iostream>
+#include <string>
+#include <string_view>
+using std::ostream;
+using std::string;
+using std::string_view;
+
+class Symbol {
+public:
+    // The empty string, which is always interned
+    Symbol() : value(0) {}
+    // Interns name if it is not already in the table
+    explicit Symbol(string_view name);
+    // Finds name without interning it; if it has never been interned,
+    // the result compares unequal to every interned symbol
+    static Symbol lookup(string_view name);
+    // Number of symbols interned so far; every symbol's id() is below this
+    static unsigned int count();
+
+    const string& str() const;
+    unsigned int id() const { return value; }
+    bool empty() const { return value == 0; }
+    bool operator==(Symbol sym) const { return value == sym.value; }
+    bool operator!=(Symbol sym) const { return value != sym.value; }
+    friend ostream& operator<<(ostream& strm, Symbol sym) {
+        return strm << sym.str();
+    }
+    static const unsigned int NOT_FOUND = 0xFFFFFFFFu;
+private:
+    explicit Symbol(unsigned int id) : value(id) {}
+    unsigned int value;
+};
+
+#endif
@@ -0,0 +1,264 @@
+/*
+    TestDungeon.cpp
+
+    Checks of behaviour that a quick game would not show: each test
+    prints one line saying whether it passed, and the program exits
+    with status 1 if any failed.
+
+    Build and run:
+        g++ -std=c++17 -O2 -pthread -o TestDungeon TestDungeon.cpp Command.cpp Dungeon.cpp DungeonGraph.cpp DungeonImage.cpp DungeonLoader.cpp DungeonServer.cpp GameSession.cpp RegionPager.cpp RoomRenderer.cpp RoomTextCache.cpp RoutePlanner.cpp Symbol.cpp Trigger.cpp WorldOverlay.cpp
+        ./TestDungeon
+*/
+#include "Dungeon.h"
+#include "DungeonGraph.h"
+#include "DungeonLoader.h"
+#include "DungeonServer.h"
+#include "RoomRenderer.h"
+#include "RoutePlanner.h"
+#include "WorldOverlay.h"
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+using std::string;
+using std::vector;
+
+static int failures = 0;
+
+// Report one test
+static void report(const char* test, bool passed) {
+    printf("%-40s %s\n", test, passed ? "ok" : "FAILED");
+    if (!passed) failures++;
+}
+
+// Small deterministic generator for test data
+static unsigned int nextRandom(unsigned int& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// A width by width grid with exits e, w, s and n where they fit, so
+// most trips have many equally short routes
+static void buildGrid(DungeonGraph& graph, unsigned int width) {
+    graph.offsets.assign(1, 0);
+    graph.targets.clear();
+    graph.directions.clear();
+    for (unsigned int r=0; r<width*width; r++) {
+        unsigned int x = r % width, y = r / width;
+        if (x+1 < width) graph.targets.push_back(r + 1);
+        if (x > 0) graph.targets.push_back(r - 1);
+        if (y+1 < width) graph.targets.push_back(r + width);
+        if (y > 0) graph.targets.push_back(r - width);
+        graph.offsets.push_back(graph.targets.size());
+    }
+    graph.directions.resize(graph.targets.size());
+}
+
+// The route the planner promises: shortest, and leaving each room by
+// its first exit that leads a move closer
+static vector<unsigned int> expectedRoute(const DungeonGraph& graph, unsigned int from, unsigned int to) {
+    static const unsigned int FAR = 0xFFFFFFFFu;
+    vector<unsigned int> distance(graph.roomCount(), FAR);
+    vector<unsigned int> queue(1, to);
+    distance[to] = 0;
+    for (unsigned int head=0; head<queue.size(); head++) {
+        for (unsigned int e=0; e<graph.edgeCount(); e++) {
+            if (graph.targets[e] == queue[head]) {
+                unsigned int source = 0;
+                while (graph.offsets[source+1] <= e) source++;
+                if (distance[source] == FAR) {
+                    distance[source] = distance[queue[head]] + 1;
+                    queue.push_back(source);
+                }
+            }
+        }
+    }
+    vector<unsigned int> edges;
+    for (unsigned int r=from; r!=to; r=graph.targets[edges.back()]) {
+        unsigned int e = graph.offsets[r];
+        while (distance[graph.targets[e]] + 1 != distance[r]) e++;
+        edges.push_back(e);
+    }
+    return edges;
+}
+
+// The same trip gives the same route from a search, from a table built
+// on demand and from a precomputed table
+static void testRouteTies() {
+    DungeonGraph graph;
+    buildGrid(graph, 12);
+    RoutePlanner planner;
+    planner.reset(&graph);
+    unsigned int rooms = graph.roomCount();
+    unsigned int state = 7;
+    bool same = true;
+    vector<unsigned int> edges;
+    for (unsigned int trip=0; trip<40; trip++) {
+        unsigned int from = nextRandom(state) % rooms;
+        unsigned int to = nextRandom(state) % rooms;
+        vector<unsigned int> expected = expectedRoute(graph, from, to);
+        // enough requests that to gets a table part way through
+        for (unsigned int i=0; i<=RoutePlanner::TABLE_AFTER_REQUESTS; i++) {
+            if (!planner.findRoute(from, to, edges) || edges != expected) same = false;
+        }
+    }
+    report("route ties broken the same way", same && planner.tableCount() > RoutePlanner::PRECOMPUTE_TARGETS);
+}
+
+// The overlay knows which owners have an item with a name, through
+// random takes, drops and removals
+static void testItemOwners() {
+    static const char* NAMES[] = { "lamp", "key", "mug" };
+    Dungeon dungeon;
+    parseDungeon(dungeon, "ROOM:a:room a:The first room.\n"
+                          "ROOM:b:room b:The second room.\n"
+                          "ROOM:c:room c:The third room.\n"
+                          "PATH:e:a:b\n"
+                          "PATH:e:b:c\n"
+                          "ITEM:lamp:A lamp.:a\n"
+                          "ITEM:lamp:Another lamp.:b\n"
+                          "ITEM:key:A key.:b\n"
+                          "ITEM:mug:A mug.:c\n"
+                          "ITEM:key:A spare key.:c\n"
+                          "INIT:a\n");
+    dungeon.buildGraph();
+    WorldOverlay world(dungeon);
+    unsigned int owners[4] = { 0, 1, 2, WorldOverlay::INVENTORY };
+    unsigned int state = 3;
+    bool same = true;
+    vector<unsigned int> found;
+    for (unsigned int step=0; step<2000; step++) {
+        Symbol name(NAMES[nextRandom(state) % 3]);
+        unsigned int from = owners[nextRandom(state) % 4];
+        unsigned int to = owners[nextRandom(state) % 4];
+        unsigned int action = nextRandom(state) % 20;
+        if (action == 0) world.removeItem(name, from);
+        else if (action == 1) world.moveAllItems(from, to);
+        else world.moveItem(name, from, to);
+
+        for (const char* check : NAMES) {
+            // every owner in order, the inventory last, as findOwners gives them
+            vector<unsigned int> expected;
+            for (unsigned int owner : owners) {
+                if (world.findItem(owner, Symbol(check)) != NULL) expected.push_back(owner);
+            }
+            world.findOwners(Symbol(check), found);
+            if (found != expected) same = false;
+        }
+    }
+    report("item owners follow every move", same);
+}
+
+// Rooms no game has changed are rendered once for every game, while a
+// room one game changes is rendered for that game alone
+static void testSharedRooms() {
+    Dungeon dungeon;
+    parseDungeon(dungeon, "ROOM:a:room a:The first room.\n"
+                          "ROOM:b:room b:The second room.\n"
+                          "PATH:e:a:b\n"
+                          "PATH:w:b:a\n"
+                          "ITEM:lamp:A lamp.:a\n"
+                          "INIT:a\n");
+    dungeon.buildGraph();
+    WorldOverlay first(dungeon), second(dungeon);
+    RoomRenderer firstRenderer(dungeon), secondRenderer(dungeon);
+    std::ostringstream firstOut, secondOut;
+    firstRenderer.render(first, 0, true, firstOut);
+    secondRenderer.render(second, 0, true, secondOut);
+    bool shared = firstOut.str() == "You are in a\nThe first room.\nA lamp.\nExits are: e\n" &&
+                  secondOut.str() == firstOut.str() && dungeon.roomText.cachedRooms() == 1 &&
+                  firstRenderer.cachedRooms() == 0 && secondRenderer.cachedRooms() == 0;
+
+    first.moveItem(Symbol("lamp"), 0, WorldOverlay::INVENTORY);
+    firstOut.str("");
+    secondOut.str("");
+    firstRenderer.render(first, 0, false, firstOut);
+    secondRenderer.render(second, 0, false, secondOut);
+    bool changed = firstOut.str() == "You are in a\nExits are: e\n" &&
+                   secondOut.str() == "You are in a\nA lamp.\nExits are: e\n" &&
+                   dungeon.roomText.cachedRooms() == 1 &&
+                   firstRenderer.cachedRooms() == 1 && secondRenderer.cachedRooms() == 0;
+    report("unchanged rooms rendered once for all", shared && changed);
+}
+
+// A player who sends many commands at once, without closing the
+// connection, gets an answer to every one of them
+static void testPipelinedInput() {
+    static const unsigned int COMMANDS = 2000;
+    Dungeon dungeon;
+    parseDungeon(dungeon, "ROOM:hall:the hall:A long hall with nothing much in it at all.\n"
+                          "ROOM:outside:outside:The day is beautiful.\n"
+                          "PATH:s:hall:outside\n"
+                          "INIT:hall\n");
+    dungeon.buildGraph();
+    char path[64];
+    snprintf(path, sizeof path, "/tmp/TestDungeon.%d.sock", (int)getpid());
+
+    fflush(stdout);
+    pid_t server = fork();
+    if (server == 0) {
+        try {
+            DungeonServer players(dungeon);
+            players.listenUnix(path);
+            players.run();
+        } catch (const string& msg) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool connected = false;
+    for (int tries=0; tries<100 && !connected; tries++) {
+        connected = connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof address) == 0;
+        if (!connected) usleep(20000);
+    }
+
+    string commands;
+    for (unsigned int i=0; i<COMMANDS; i++) commands += "look\n";
+    std::size_t sent = 0;
+    while (connected && sent < commands.size()) {
+        ssize_t n = send(fd, commands.data() + sent, commands.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += n;
+    }
+
+    // one prompt to start and one after each command
+    static const string PROMPT = "Enter command: ";
+    string received;
+    std::size_t counted = 0;    // received is searched from here on
+    unsigned int prompts = 0;
+    char buffer[4096];
+    struct pollfd wait = { fd, POLLIN, 0 };
+    while (connected && prompts < COMMANDS + 1 && poll(&wait, 1, 5000) > 0) {
+        ssize_t n = recv(fd, buffer, sizeof buffer, 0);
+        if (n <= 0) break;
+        received.append(buffer, n);
+        for (std::size_t at; (at = received.find(PROMPT, counted)) != string::npos; counted = at + PROMPT.size()) {
+            prompts++;
+        }
+    }
+    ::close(fd);
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    report("pipelined commands all answered", prompts == COMMANDS + 1);
+}
+
+int main() {
+    testRouteTies();
+    testItemOwners();
+    testSharedRooms();
+    testPipelinedInput();
+    return (failures == 0) ? 0 : 1;
+}
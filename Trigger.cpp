@@ -0,0 +1,92 @@
+/*
+    Trigger.cpp
+
+    This is the implementation file for Trigger and TriggerTable objects.
+*/
+
+#include "Trigger.h"
+
+const char* const TriggerTable::EVENT_NAMES[NUM_TRIGGER_EVENTS] = { "drop", "take", "xyzzy" };
+
+TriggerTable::TriggerTable() : groupStart(0) {}
+
+unsigned long long TriggerTable::key(Symbol room, Symbol item) {
+    return ((unsigned long long)room.id() << 32) | item.id();
+}
+
+// The triggers declared for an event in a room for an item, or NULL
+const std::vector<unsigned int>* TriggerTable::bucket(TriggerEvent event, Symbol room, Symbol item) const {
+    const std::unordered_map<unsigned long long, std::vector<unsigned int> >& byKey = index[event];
+    if (byKey.empty()) return NULL;
+    std::unordered_map<unsigned long long, std::vector<unsigned int> >::const_iterator it = byKey.find(key(room, item));
+    return (it == byKey.end()) ? NULL : &it->second;
+}
+
+// Add a trigger with no conditions or actions yet, and index it
+Trigger& TriggerTable::add(TriggerEvent event, Symbol room, Symbol item) {
+    // a trigger after one with actions starts a new group
+    if (!triggers.empty() && !triggers.back().actions.empty()) groupStart = triggers.size();
+    index[event][key(room, item)].push_back(triggers.size());
+    triggers.push_back(Trigger());
+    Trigger& trigger = triggers.back();
+    trigger.event = event;
+    trigger.room = room;
+    trigger.item = item;
+    return trigger;
+}
+
+// Add an action to every trigger in the latest group
+void TriggerTable::addAction(const TriggerAction& action) {
+    for (unsigned int t=groupStart; t<triggers.size(); t++) triggers[t].actions.push_back(action);
+}
+
+string TriggerTable::records() const {
+    string text;
+    auto name = [](Symbol s) { return s.empty() ? string("*") : s.str(); };
+    for (const Trigger& trigger : triggers) {
+        text += "WHEN:";
+        text += EVENT_NAMES[trigger.event];
+        text += ':' + name(trigger.room) + ':' + name(trigger.item);
+        if (!trigger.conditions.empty()) {
+            const char* separator = ":";
+            for (const TriggerCondition& condition : trigger.conditions) {
+                text += separator;
+                text += (condition.kind == TriggerCondition::HERE) ? "here " : "carrying ";
+                text += condition.item.str();
+                separator = ", ";
+            }
+        }
+        text += '\n';
+        for (const TriggerAction& action : trigger.actions) {
+            text += "THEN:";
+            switch (action.kind) {
+            case TriggerAction::SAY:
+                text += "say:" + action.text;
+                break;
+            case TriggerAction::REMOVE:
+                text += "remove:" + action.item.str();
+                break;
+            case TriggerAction::PATH:
+                text += "path:" + action.direction.str() + ':' + action.room.str() + ':' + action.to.str();
+                break;
+            case TriggerAction::REPLACE:
+                text += "replace:" + action.room.str() + ':' + action.text + ':' + action.replacement;
+                break;
+            case TriggerAction::DESCRIBE:
+                text += "describe:" + action.room.str() + ':' + action.text;
+                break;
+            case TriggerAction::TELEPORT:
+                text += "teleport:" + action.room.str();
+                break;
+            }
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+void TriggerTable::clear() {
+    triggers.clear();
+    groupStart = 0;
+    for (unsigned int e=0; e<NUM_TRIGGER_EVENTS; e++) index[e].clear();
+}
@@ -0,0 +1,130 @@
+/*
+    Trigger.h
+
+    This is the header file for Trigger and TriggerTable objects. A
+    Trigger is a scripted event declared in the data file: when the
+    player drops or takes an item, or says xyzzy, in a room, and the
+    trigger's conditions hold, its actions change the player's world.
+
+    A TriggerTable keeps the triggers in the order they were declared,
+    with an index from (event, room, item) to the triggers declared for
+    them. A command looks only at the triggers that name its event and
+    its room or item, or that match any room or item, so its cost does
+    not grow with the number of triggers in the dungeon.
+*/
+
+#ifndef __TRIGGER_H__
+#define __TRIGGER_H__
+
+#include "Symbol.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using std::string;
+
+enum TriggerEvent {
+    ON_DROP,        // an item has been dropped
+    ON_TAKE,        // an item has been taken
+    ON_XYZZY,       // the player said xyzzy; there is no item
+    NUM_TRIGGER_EVENTS
+};
+
+class TriggerCondition {
+public:
+    enum Kind {
+        HERE,       // the item is in the room where the event happened
+        CARRYING    // the player carries the item
+    };
+    Kind kind;
+    Symbol item;
+};
+
+class TriggerAction {
+public:
+    enum Kind {
+        SAY,        // print text
+        REMOVE,     // remove item from the room, or else from the player
+        PATH,       // add an exit direction from room to to
+        REPLACE,    // in room's description, replace the last text with replacement
+        DESCRIBE,   // set room's description to text
+        TELEPORT    // move the player to room
+    };
+    Kind kind;
+    Symbol room;
+    Symbol item;
+    Symbol direction;
+    Symbol to;
+    string text;
+    string replacement;
+};
+
+class Trigger {
+public:
+    TriggerEvent event;
+    Symbol room;        // empty for any room
+    Symbol item;        // empty for any item
+    std::vector<TriggerCondition> conditions;
+    std::vector<TriggerAction> actions;
+};
+
+// Triggers must be added through add so that they are indexed. Actions
+// are added with addAction to every trigger declared since the last
+// action, so several triggers can share one list of actions.
+class TriggerTable {
+public:
+    TriggerTable();
+    Trigger& add(TriggerEvent event, Symbol room, Symbol item);
+    void addAction(const TriggerAction& action);
+    bool empty() const { return triggers.empty(); }
+    unsigned int size() const { return triggers.size(); }
+    std::vector<Trigger>::const_iterator begin() const { return triggers.begin(); }
+    std::vector<Trigger>::const_iterator end() const { return triggers.end(); }
+    template <typename F>
+    bool forEachCandidate(TriggerEvent event, Symbol room, Symbol item, F f) const;
+    // The triggers as data file records, which parse back to the same table
+    string records() const;
+    void clear();
+
+    // Name of each event in the data file
+    static const char* const EVENT_NAMES[NUM_TRIGGER_EVENTS];
+private:
+    std::vector<Trigger> triggers;
+    unsigned int groupStart;    // first trigger that the next action goes to
+    // the triggers declared for each (room, item), in order, by event
+    std::unordered_map<unsigned long long, std::vector<unsigned int> > index[NUM_TRIGGER_EVENTS];
+    static unsigned long long key(Symbol room, Symbol item);
+    const std::vector<unsigned int>* bucket(TriggerEvent event, Symbol room, Symbol item) const;
+};
+
+// Calls f(const Trigger&) for each trigger that could fire for an event
+// in a room, in the order they were declared, until f returns true
+// Returns true if f did.
+template <typename F>
+bool TriggerTable::forEachCandidate(TriggerEvent event, Symbol room, Symbol item, F f) const {
+    if (triggers.empty()) return false;
+    const std::vector<unsigned int>* lists[4];
+    unsigned int count = 0;
+    Symbol rooms[2] = { room, Symbol() };
+    Symbol items[2] = { item, Symbol() };
+    for (unsigned int r = room.empty() ? 1 : 0; r<2; r++) {
+        for (unsigned int i = item.empty() ? 1 : 0; i<2; i++) {
+            const std::vector<unsigned int>* list = bucket(event, rooms[r], items[i]);
+            if (list != NULL) lists[count++] = list;
+        }
+    }
+
+    // merge the lists, which are each in the order declared
+    std::size_t at[4] = { 0, 0, 0, 0 };
+    while (true) {
+        unsigned int next = count;
+        for (unsigned int l=0; l<count; l++) {
+            if (at[l] < lists[l]->size() &&
+                (next == count || (*lists[l])[at[l]] < (*lists[next])[at[next]])) next = l;
+        }
+        if (next == count) return false;
+        if (f(triggers[(*lists[next])[at[next]++]])) return true;
+    }
+}
+
+#endif
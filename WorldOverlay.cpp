@@ -0,0 +1,340 @@
+/*
+    WorldOverlay.cpp
+
+    This is the implementation file for a WorldOverlay object.
+*/
+
+#include "WorldOverlay.h"
+#include <algorithm>
+#include <utility>
+
+const unsigned int WorldOverlay::INVENTORY;
+
+WorldOverlay::WorldOverlay(const Dungeon& base) : base(base) {
+    for (const Item& item : base.inventory) place(inventory, INVENTORY, &item);
+}
+
+// The changes made to a room, or NULL if there are none
+const WorldOverlay::RoomChanges* WorldOverlay::changes(unsigned int room) const {
+    if (rooms.empty()) return NULL;
+    std::unordered_map<unsigned int, RoomChanges>::const_iterator it = rooms.find(room);
+    return (it == rooms.end()) ? NULL : &it->second;
+}
+
+// An owner's item list, copied from the base world the first time it
+// is about to change; callers always change it
+WorldOverlay::ItemList* WorldOverlay::copiedItems(unsigned int owner) {
+    if (owner == INVENTORY) return &inventory;
+    if (owner >= base.rooms.size()) return NULL;
+    RoomChanges& c = rooms[owner];
+    c.revision++;
+    if (!c.itemsCopied) {
+        for (const Item& item : base.rooms[owner].items) place(c.items, owner, &item);
+        c.itemsCopied = true;
+    }
+    return &c.items;
+}
+
+unsigned int WorldOverlay::itemCount(unsigned int owner) const {
+    if (owner == INVENTORY) return inventory.count;
+    const RoomChanges* c = changes(owner);
+    return (c != NULL && c->itemsCopied) ? c->items.count : base.rooms[owner].items.size();
+}
+
+// Find the last item an owner has with the given name
+// Returns NULL if it has none.
+const Item* WorldOverlay::findItem(unsigned int owner, Symbol name) const {
+    const RoomChanges* c = (owner == INVENTORY) ? NULL : changes(owner);
+    if (owner == INVENTORY) return inventory.last(name);
+    if (c != NULL && c->itemsCopied) return c->items.last(name);
+    return base.findItem(base.rooms[owner].id, name);
+}
+
+// Move the last item named name from one owner to the end of another's
+// list; returns false if from has no such item or to does not exist
+bool WorldOverlay::moveItem(Symbol name, unsigned int from, unsigned int to) {
+    if (findItem(from, name) == NULL || (to != INVENTORY && to >= base.rooms.size())) return false;
+    ItemList& source = *copiedItems(from);
+    ItemList& dest = *copiedItems(to);
+    place(dest, to, take(source, name));
+    return true;
+}
+
+// Move every item from one owner to the end of another's list
+void WorldOverlay::moveAllItems(unsigned int from, unsigned int to) {
+    if (from == to || itemCount(from) == 0 || (to != INVENTORY && to >= base.rooms.size())) return;
+    ItemList& source = *copiedItems(from);
+    ItemList& dest = *copiedItems(to);
+    for (const Item* item : source.slots) {
+        if (item != NULL) place(dest, to, item);
+    }
+    for (const auto& entry : source.positions) {
+        if (!entry.second.slots.empty()) forgetOwner(source, entry.first);
+    }
+    source.clear();
+}
+
+// Remove the last item named name that an owner has
+// Returns false if it has none.
+bool WorldOverlay::removeItem(Symbol name, unsigned int owner) {
+    if (findItem(owner, name) == NULL) return false;
+    take(*copiedItems(owner), name);
+    return true;
+}
+
+// Every owner that has an item with the given name, rooms in index
+// order and then the inventory: the owners the overlay has changed
+// from its own index, the others from the base world's
+void WorldOverlay::findOwners(Symbol name, std::vector<unsigned int>& found) const {
+    found.clear();
+    for (Symbol owner : base.itemIndex.owners(name)) {
+        if (owner.empty()) continue;    // the inventory is always the overlay's
+        RoomHandle room = base.findRoom(owner);
+        if (!room.valid()) continue;
+        const RoomChanges* c = changes(room.index);
+        if (c == NULL || !c->itemsCopied) found.push_back(room.index);
+    }
+    std::unordered_map<unsigned int, std::vector<unsigned int> >::const_iterator it = owners.find(name.id());
+    if (it != owners.end()) found.insert(found.end(), it->second.begin(), it->second.end());
+    std::sort(found.begin(), found.end());
+}
+
+// Add an item to an owner's list, noting the owner if it had none by
+// that name
+void WorldOverlay::place(ItemList& items, unsigned int owner, const Item* item) {
+    items.add(item);
+    ItemList::Named& named = items.positions[item->name.id()];
+    if (named.slots.size() == 1) {
+        std::vector<unsigned int>& list = owners[item->name.id()];
+        named.ownerSlot = list.size();
+        list.push_back(owner);
+    }
+}
+
+// Take the last item with a name from an owner's list, forgetting the
+// owner if that was its last one
+const Item* WorldOverlay::take(ItemList& items, Symbol name) {
+    const Item* item = items.take(name);
+    if (item != NULL && items.last(name) == NULL) forgetOwner(items, name.id());
+    return item;
+}
+
+// Swap an owner that has no more items with a name out of owners; the
+// emptied entries are kept, so items going back and forth between the
+// same owners do not allocate
+void WorldOverlay::forgetOwner(ItemList& items, unsigned int name) {
+    std::vector<unsigned int>& list = owners[name];
+    unsigned int slot = items.positions[name].ownerSlot;
+    if (slot + 1 < list.size()) {
+        list[slot] = list.back();
+        ItemList& moved = (list[slot] == INVENTORY) ? inventory : rooms.find(list[slot])->second.items;
+        moved.positions[name].ownerSlot = slot;
+    }
+    list.pop_back();
+}
+
+// The last item in the list with the given name, or NULL
+const Item* WorldOverlay::ItemList::last(Symbol name) const {
+    std::unordered_map<unsigned int, Named>::const_iterator it = positions.find(name.id());
+    return (it == positions.end() || it->second.slots.empty()) ? NULL : slots[it->second.slots.back()];
+}
+
+// Add an item at the end of the list
+void WorldOverlay::ItemList::add(const Item* item) {
+    positions[item->name.id()].slots.push_back(slots.size());
+    slots.push_back(item);
+    count++;
+}
+
+// Take the last item with the given name out of the list
+// Returns NULL if there is none.
+const Item* WorldOverlay::ItemList::take(Symbol name) {
+    std::unordered_map<unsigned int, Named>::iterator it = positions.find(name.id());
+    if (it == positions.end() || it->second.slots.empty()) return NULL;
+    unsigned int slot = it->second.slots.back();
+    it->second.slots.pop_back();
+    const Item* item = slots[slot];
+    slots[slot] = NULL;
+    count--;
+    while (!slots.empty() && slots.back() == NULL) slots.pop_back();
+    if (slots.size() > 2 * count + 16) compact();
+    return item;
+}
+
+void WorldOverlay::ItemList::clear() {
+    slots.clear();
+    count = 0;
+    positions.clear();
+}
+
+// Squeeze out the gaps left by taken items
+void WorldOverlay::ItemList::compact() {
+    for (auto& entry : positions) entry.second.slots.clear();
+    unsigned int kept = 0;
+    for (const Item* item : slots) {
+        if (item == NULL) continue;
+        positions[item->name.id()].slots.push_back(kept);
+        slots[kept++] = item;
+    }
+    slots.resize(kept);
+}
+
+unsigned int WorldOverlay::pathCount(unsigned int room) const {
+    const RoomChanges* c = changes(room);
+    return base.rooms[room].pathCount + ((c == NULL) ? 0 : c->paths.size());
+}
+
+// Find the exit from a room in a direction; returns NULL if there is none
+const Path* WorldOverlay::getPath(unsigned int room, Symbol dir) const {
+    const Path* path = base.rooms[room].getPath(dir);
+    if (path != NULL) return path;
+    const RoomChanges* c = changes(room);
+    if (c != NULL) {
+        for (const Path& added : c->paths) {
+            if (added.direction == dir) return &added;
+        }
+    }
+    return NULL;
+}
+
+// Find the exit from a room in a standard direction; returns NULL if
+// there is none
+const Path* WorldOverlay::getExit(unsigned int room, Direction d) const {
+    const Path& exit = base.rooms[room].exits[d];
+    if (!exit.to.empty()) return &exit;
+    const RoomChanges* c = changes(room);
+    if (c != NULL) {
+        for (const Path& added : c->paths) {
+            if (directionOf(added.direction) == d) return &added;
+        }
+    }
+    return NULL;
+}
+
+// Add an exit to a room; returns false if it already has one that way
+bool WorldOverlay::addPath(unsigned int room, Symbol dir, Symbol to) {
+    if (room >= base.rooms.size() || getPath(room, dir) != NULL) return false;
+    RoomChanges& c = rooms[room];
+    c.paths.emplace_back(dir, to);
+    c.revision++;
+    RoomHandle next = base.findRoom(to);
+    if (next.valid()) {
+        AddedEdge edge = { room, next.index, dir };
+        std::vector<AddedEdge>::iterator at = std::upper_bound(addedEdges.begin(), addedEdges.end(), room,
+            [](unsigned int r, const AddedEdge& e) { return r < e.from; });
+        addedEdges.insert(at, edge);
+    }
+    return true;
+}
+
+// Find a shortest route; directions receives the exits to take, in order
+// Returns false if to cannot be reached from from. Until an exit to a
+// known room has been added the base world's route planner answers;
+// after that the added exits are searched along with the base graph,
+// in the calling thread's scratch arrays.
+bool WorldOverlay::findRoute(unsigned int from, unsigned int to, std::vector<Symbol>& directions) const {
+    directions.clear();
+    const DungeonGraph& graph = base.graph;
+    if (addedEdges.empty()) {
+        std::vector<unsigned int> edges;
+        if (!base.routes.findRoute(from, to, edges)) return false;
+        for (unsigned int edge : edges) directions.push_back(graph.directions[edge]);
+        return true;
+    }
+
+    // breadth-first search; an exit taken is a base graph edge, or the
+    // edge count plus the position of an added one
+    unsigned int n = graph.roomCount();
+    unsigned int edgeCount = graph.edgeCount();
+    if (from >= n || to >= n) return false;
+    SearchScratch& scratch = SearchScratch::local();
+    scratch.start(n);
+    scratch.visit(from, from, 0);
+    scratch.queue.push_back(from);
+    for (std::size_t head=0; head<scratch.queue.size() && !scratch.visited(to); head++) {
+        unsigned int r = scratch.queue[head];
+        auto reach = [&](unsigned int next, unsigned int via) {
+            if (!scratch.visited(next)) {
+                scratch.visit(next, r, via);
+                scratch.queue.push_back(next);
+            }
+        };
+        for (unsigned int e=graph.offsets[r]; e<graph.offsets[r+1]; e++) {
+            if (graph.targets[e] != DungeonGraph::NO_TARGET) reach(graph.targets[e], e);
+        }
+        std::vector<AddedEdge>::const_iterator added = std::lower_bound(addedEdges.begin(), addedEdges.end(), r,
+            [](const AddedEdge& e, unsigned int room) { return e.from < room; });
+        for (; added != addedEdges.end() && added->from == r; ++added) {
+            reach(added->to, edgeCount + (added - addedEdges.begin()));
+        }
+    }
+    if (!scratch.visited(to)) return false;
+    for (unsigned int r=to; r!=from; r=scratch.from[r]) {
+        unsigned int via = scratch.via[r];
+        directions.push_back((via < edgeCount) ? graph.directions[via] : addedEdges[via - edgeCount].direction);
+    }
+    std::reverse(directions.begin(), directions.end());
+    return true;
+}
+
+string WorldOverlay::roomDescription(unsigned int room) const {
+    const RoomChanges* c = changes(room);
+    return (c != NULL && c->described) ? c->description : base.roomDescription(room);
+}
+
+void WorldOverlay::setRoomDescription(unsigned int room, string desc) {
+    if (room >= base.rooms.size()) return;
+    RoomChanges& c = rooms[room];
+    c.description = std::move(desc);
+    c.described = true;
+    c.revision++;
+}
+
+bool WorldOverlay::visited(unsigned int room) const {
+    return seen.count(room) != 0;
+}
+
+void WorldOverlay::setVisited(unsigned int room, bool isSeen) {
+    if (isSeen) seen.insert(room);
+    else seen.erase(room);
+}
+
+unsigned int WorldOverlay::changedRooms() const {
+    return rooms.size();
+}
+
+unsigned int WorldOverlay::revision(unsigned int room) const {
+    const RoomChanges* c = changes(room);
+    return (c == NULL) ? 0 : c->revision;
+}
+
+void WorldOverlay::writeState(std::ostream& out) const {
+    out << "inventory:";
+    for (const Item* item : inventory.slots) {
+        if (item != NULL) out << ' ' << item->name;
+    }
+    out << '\n';
+
+    std::vector<unsigned int> changed;
+    for (const auto& entry : rooms) changed.push_back(entry.first);
+    std::sort(changed.begin(), changed.end());
+    for (unsigned int room : changed) {
+        const RoomChanges& c = rooms.find(room)->second;
+        out << "room " << base.rooms[room].id << '\n';
+        if (c.itemsCopied) {
+            out << "  items:";
+            for (const Item* item : c.items.slots) {
+                if (item != NULL) out << ' ' << item->name;
+            }
+            out << '\n';
+        }
+        for (const Path& path : c.paths) out << "  path " << path.direction << " to " << path.to << '\n';
+        if (c.described) out << "  description " << c.description << '\n';
+    }
+
+    std::vector<unsigned int> visitedRooms(seen.begin(), seen.end());
+    std::sort(visitedRooms.begin(), visitedRooms.end());
+    out << "visited:";
+    for (unsigned int room : visitedRooms) out << ' ' << base.rooms[room].id;
+    out << '\n';
+}
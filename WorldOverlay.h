@@ -0,0 +1,160 @@
+/*
+    WorldOverlay.h
+
+    This is the header file for a WorldOverlay object. A WorldOverlay
+    is one player's view of a Dungeon that is shared, unchanged, by
+    every player: the Dungeon is the base world, and the overlay
+    records only what this player's game has changed in it.
+
+    A room's item list is copied into the overlay the first time the
+    player takes something from it or drops something in it; the copy
+    holds pointers to the base world's items, never the items
+    themselves, and is indexed by item name like the inventory, so
+    taking or dropping an item costs the same however many there are.
+    Exits added by events, rewritten descriptions and the rooms the
+    player has seen are kept the same way, by room index. A room the
+    player has not changed is read straight from the base, so an
+    overlay's size follows what the player has done, not the size of
+    the world.
+*/
+
+#ifndef __WORLD_OVERLAY_H__
+#define __WORLD_OVERLAY_H__
+
+#include "Dungeon.h"
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+using std::string;
+
+class WorldOverlay {
+public:
+    // The owner that stands for the player's inventory rather than a room
+    static const unsigned int INVENTORY = 0xFFFFFFFFu;
+
+    explicit WorldOverlay(const Dungeon& base);
+
+    // Items, by owner: a room index or INVENTORY
+    unsigned int itemCount(unsigned int owner) const;
+    template <typename F> void forEachItem(unsigned int owner, F f) const;
+    const Item* findItem(unsigned int owner, Symbol name) const;
+    bool moveItem(Symbol name, unsigned int from, unsigned int to);
+    void moveAllItems(unsigned int from, unsigned int to);
+    bool removeItem(Symbol name, unsigned int owner);
+    void findOwners(Symbol name, std::vector<unsigned int>& owners) const;
+
+    // Exits
+    unsigned int pathCount(unsigned int room) const;
+    template <typename F> void forEachPath(unsigned int room, F f) const;
+    const Path* getPath(unsigned int room, Symbol dir) const;
+    const Path* getExit(unsigned int room, Direction d) const;
+    bool addPath(unsigned int room, Symbol dir, Symbol to);
+    bool findRoute(unsigned int from, unsigned int to, std::vector<Symbol>& directions) const;
+
+    // Descriptions and visited flags
+    string roomDescription(unsigned int room) const;
+    void setRoomDescription(unsigned int room, string desc);
+    bool visited(unsigned int room) const;
+    void setVisited(unsigned int room, bool seen);
+
+    // Number of rooms whose items, exits or description have changed
+    unsigned int changedRooms() const;
+    // Counts the changes to a room's items, exits and description, so
+    // text rendered from the room can tell when it is out of date; 0 for
+    // a room that has not changed
+    unsigned int revision(unsigned int room) const;
+    // Writes every change, in room order, as text that is the same for
+    // the same changes however they were made
+    void writeState(std::ostream& out) const;
+private:
+    // An owner's items in order. Taking one leaves a gap rather than
+    // moving the ones after it up, and positions finds the last one
+    // with a name; the gaps are squeezed out once they outnumber the
+    // items.
+    struct ItemList {
+        std::vector<const Item*> slots;     // NULL where an item was taken
+        unsigned int count = 0;
+        struct Named {
+            std::vector<unsigned int> slots;    // holding the name, in order
+            unsigned int ownerSlot = 0;         // the owner's place in owners[name]
+        };
+        std::unordered_map<unsigned int, Named> positions;     // by item name id
+        const Item* last(Symbol name) const;
+        void add(const Item* item);
+        const Item* take(Symbol name);
+        void clear();
+        void compact();
+    };
+    struct RoomChanges {
+        bool itemsCopied = false;
+        ItemList items;                     // the room's items, once copied
+        std::vector<Path> paths;            // exits added to the room
+        bool described = false;
+        string description;
+        unsigned int revision = 0;
+    };
+    const Dungeon& base;
+    std::unordered_map<unsigned int, RoomChanges> rooms;
+    ItemList inventory;
+    std::unordered_set<unsigned int> seen;
+    // the added exits that lead to a known room, by room they leave
+    // from, so route searches need not look the rooms up
+    struct AddedEdge {
+        unsigned int from;
+        unsigned int to;
+        Symbol direction;
+    };
+    std::vector<AddedEdge> addedEdges;
+
+    // by item name id, the owners in the overlay (copied rooms and the
+    // inventory) that have an item with that name, in no order
+    std::unordered_map<unsigned int, std::vector<unsigned int> > owners;
+
+    const RoomChanges* changes(unsigned int room) const;
+    ItemList* copiedItems(unsigned int owner);
+    void place(ItemList& items, unsigned int owner, const Item* item);
+    const Item* take(ItemList& items, Symbol name);
+    void forgetOwner(ItemList& items, unsigned int name);
+};
+
+// Calls f(const Item&) for each item an owner has, in order
+template <typename F>
+void WorldOverlay::forEachItem(unsigned int owner, F f) const {
+    const RoomChanges* c = (owner == INVENTORY) ? NULL : changes(owner);
+    if (owner == INVENTORY || (c != NULL && c->itemsCopied)) {
+        for (const Item* item : ((owner == INVENTORY) ? inventory : c->items).slots) {
+            if (item != NULL) f(*item);
+        }
+    } else {
+        for (const Item& item : base.rooms[owner].items) f(item);
+    }
+}
+
+// Calls f(const Path&) for each exit of a room: the standard
+// directions in order, then any others, as Room::forEachPath does
+template <typename F>
+void WorldOverlay::forEachPath(unsigned int room, F f) const {
+    const RoomChanges* c = changes(room);
+    if (c == NULL || c->paths.empty()) {
+        base.rooms[room].forEachPath(f);
+        return;
+    }
+    const Room& r = base.rooms[room];
+    for (unsigned int d=0; d<NUM_DIRECTIONS; d++) {
+        if (!r.exits[d].to.empty()) f(r.exits[d]);
+        else {
+            for (const Path& path : c->paths) {
+                if (directionOf(path.direction) == d) f(path);
+            }
+        }
+    }
+    for (const Path& path : r.customPaths) f(path);
+    for (const Path& path : c->paths) {
+        if (directionOf(path.direction) == NUM_DIRECTIONS) f(path);
+    }
+}
+
+#endif